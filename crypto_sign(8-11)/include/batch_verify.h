@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Пакетная проверка подписей одного открытого ключа (GOST341094, FIPS186)
+
+using SignaturePair = std::pair<std::vector<unsigned char>, std::vector<unsigned char>>;
+
+struct BatchItem {
+    std::vector<unsigned char> hash;
+    SignaturePair signature;
+};
+
+struct BatchResult {
+    std::vector<unsigned char> valid; // 1 — подпись верна, по одному на элемент
+    size_t valid_count = 0;
+    double seconds = 0;               // общее время, включая предвычисления
+    double per_second = 0;            // проверок в секунду
+};
@@ -0,0 +1,448 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+// Беззнаковое целое фиксированной ширины: N слов по 64 бита, младшее слово первым.
+// Байтовое представление (from_bytes/to_bytes) — little-endian, как у to_uint64.
+template <size_t N>
+struct BigUInt {
+    uint64_t limb[N] = {};
+
+    static constexpr BigUInt from_u64(uint64_t v) {
+        BigUInt r;
+        r.limb[0] = v;
+        return r;
+    }
+
+    // Шестнадцатеричная строка, старшие разряды первыми
+    static constexpr BigUInt from_hex(const char* hex) {
+        BigUInt r;
+        size_t len = 0;
+        while (hex[len]) ++len;
+        if (len > N * 16) throw std::invalid_argument("BigUInt::from_hex: value too wide");
+        for (size_t i = 0; i < len; ++i) {
+            char ch = hex[len - 1 - i];
+            uint64_t d = 0;
+            if (ch >= '0' && ch <= '9') d = ch - '0';
+            else if (ch >= 'a' && ch <= 'f') d = ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F') d = ch - 'A' + 10;
+            else throw std::invalid_argument("BigUInt::from_hex: bad digit");
+            r.limb[i / 16] |= d << (4 * (i % 16));
+        }
+        return r;
+    }
+
+    std::string to_hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        for (size_t i = N * 16; i-- > 0;) {
+            unsigned d = (limb[i / 16] >> (4 * (i % 16))) & 0xF;
+            if (d || !out.empty()) out.push_back(digits[d]);
+        }
+        return out.empty() ? "0" : out;
+    }
+
+    // Значение не должно превышать ширину N слов — без молчаливого усечения
+    static BigUInt from_bytes(const std::vector<unsigned char>& v) {
+        BigUInt r;
+        for (size_t i = 0; i < v.size(); ++i) {
+            if (i >= N * 8) {
+                if (v[i] != 0) throw std::invalid_argument("BigUInt::from_bytes: value too wide");
+                continue;
+            }
+            r.limb[i / 8] |= uint64_t(v[i]) << (8 * (i % 8));
+        }
+        return r;
+    }
+
+    // Минимальное little-endian представление (ноль — один нулевой байт)
+    std::vector<unsigned char> to_bytes() const {
+        std::vector<unsigned char> out(N * 8);
+        for (size_t i = 0; i < N * 8; ++i) out[i] = static_cast<unsigned char>(limb[i / 8] >> (8 * (i % 8)));
+        while (out.size() > 1 && out.back() == 0) out.pop_back();
+        return out;
+    }
+
+    constexpr bool is_zero() const {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < N; ++i) acc |= limb[i];
+        return acc == 0;
+    }
+
+    constexpr bool bit(size_t i) const { return (limb[i / 64] >> (i % 64)) & 1; }
+
+    constexpr size_t bit_length() const {
+        for (size_t i = N; i-- > 0;) {
+            if (limb[i]) return i * 64 + 64 - __builtin_clzll(limb[i]);
+        }
+        return 0;
+    }
+};
+
+template <size_t N>
+constexpr int cmp(const BigUInt<N>& a, const BigUInt<N>& b) {
+    for (size_t i = N; i-- > 0;) {
+        if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+template <size_t N>
+constexpr bool operator==(const BigUInt<N>& a, const BigUInt<N>& b) { return cmp(a, b) == 0; }
+template <size_t N>
+constexpr bool operator!=(const BigUInt<N>& a, const BigUInt<N>& b) { return cmp(a, b) != 0; }
+template <size_t N>
+constexpr bool operator<(const BigUInt<N>& a, const BigUInt<N>& b) { return cmp(a, b) < 0; }
+
+// r = a + b, возвращает перенос
+template <size_t N>
+constexpr uint64_t add(BigUInt<N>& r, const BigUInt<N>& a, const BigUInt<N>& b) {
+    unsigned __int128 c = 0;
+    for (size_t i = 0; i < N; ++i) {
+        c += (unsigned __int128)a.limb[i] + b.limb[i];
+        r.limb[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    return (uint64_t)c;
+}
+
+// r = a - b, возвращает заём
+template <size_t N>
+constexpr uint64_t sub(BigUInt<N>& r, const BigUInt<N>& a, const BigUInt<N>& b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < N; ++i) {
+        unsigned __int128 d = (unsigned __int128)a.limb[i] - b.limb[i] - borrow;
+        r.limb[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    return borrow;
+}
+
+// (a + b) mod m, при a, b < m
+template <size_t N>
+constexpr BigUInt<N> add_mod(const BigUInt<N>& a, const BigUInt<N>& b, const BigUInt<N>& m) {
+    BigUInt<N> r;
+    uint64_t carry = add(r, a, b);
+    if (carry || !(r < m)) sub(r, r, m);
+    return r;
+}
+
+// (a - b) mod m, при a, b < m
+template <size_t N>
+constexpr BigUInt<N> sub_mod(const BigUInt<N>& a, const BigUInt<N>& b, const BigUInt<N>& m) {
+    BigUInt<N> r;
+    if (sub(r, a, b)) add(r, r, m);
+    return r;
+}
+
+// mask = ~0 — a, 0 — b; без ветвлений
+template <size_t N>
+constexpr BigUInt<N> ct_select(uint64_t mask, const BigUInt<N>& a, const BigUInt<N>& b) {
+    BigUInt<N> r;
+    for (size_t i = 0; i < N; ++i) r.limb[i] = (a.limb[i] & mask) | (b.limb[i] & ~mask);
+    return r;
+}
+
+// ~0, если x == y, иначе 0; без ветвлений
+constexpr uint64_t ct_eq_mask(uint64_t x, uint64_t y) {
+    uint64_t d = x ^ y;
+    return ((d | (0 - d)) >> 63) - 1;
+}
+
+// x mod m для x произвольной ширины M: побитовый сдвиг с вычитанием.
+// Медленно; для нечётных модулей есть Montgomery::reduce.
+template <size_t M, size_t N>
+constexpr BigUInt<N> mod_reduce(const BigUInt<M>& x, const BigUInt<N>& m) {
+    BigUInt<N> r;
+    for (size_t i = x.bit_length(); i-- > 0;) {
+        uint64_t top = r.limb[N - 1] >> 63;
+        for (size_t j = N - 1; j > 0; --j) r.limb[j] = (r.limb[j] << 1) | (r.limb[j - 1] >> 63);
+        r.limb[0] = (r.limb[0] << 1) | (x.bit(i) ? 1 : 0);
+        if (top || !(r < m)) sub(r, r, m);
+    }
+    return r;
+}
+
+// Арифметика Монтгомери по нечётному модулю m (R = 2^(64N)).
+template <size_t N>
+class Montgomery {
+private:
+    BigUInt<N> m_;
+    BigUInt<N> r2_;   // R^2 mod m
+    uint64_t m_inv_ = 0; // -m^(-1) mod 2^64
+
+    // Редукция Монтгомери произведения t (2N слов): t * R^(-1) mod m
+    constexpr BigUInt<N> redc(uint64_t* t) const {
+        uint64_t top = 0;
+        for (size_t i = 0; i < N; ++i) {
+            uint64_t c = 0, u = t[i] * m_inv_;
+            for (size_t j = 0; j < N; ++j) {
+                unsigned __int128 x = (unsigned __int128)u * m_.limb[j] + t[i + j] + c;
+                t[i + j] = (uint64_t)x;
+                c = (uint64_t)(x >> 64);
+            }
+            unsigned __int128 x = (unsigned __int128)t[i + N] + c + top;
+            t[i + N] = (uint64_t)x;
+            top = (uint64_t)(x >> 64);
+        }
+        BigUInt<N> res, red;
+        for (size_t i = 0; i < N; ++i) res.limb[i] = t[N + i];
+        // Вычитание m без ветвления: время не зависит от значений
+        uint64_t borrow = sub(red, res, m_);
+        uint64_t mask = 0 - (top | (borrow ^ 1));
+        for (size_t i = 0; i < N; ++i) res.limb[i] = (red.limb[i] & mask) | (res.limb[i] & ~mask);
+        return res;
+    }
+
+public:
+    constexpr explicit Montgomery(const BigUInt<N>& modulus) : m_(modulus) {
+        if ((m_.limb[0] & 1) == 0) throw std::invalid_argument("Montgomery: modulus must be odd");
+        uint64_t inv = m_.limb[0];
+        for (int i = 0; i < 5; ++i) inv *= 2 - m_.limb[0] * inv;
+        m_inv_ = ~inv + 1;
+
+        BigUInt<2 * N + 1> r2;
+        r2.limb[2 * N] = 1;
+        r2_ = mod_reduce(r2, m_);
+    }
+
+    constexpr const BigUInt<N>& modulus() const { return m_; }
+
+    // a * b * R^(-1) mod m, при a < R, b < m.
+    // Сначала полное произведение 2N слов, затем редукция по словам (SOS):
+    // у каждого внутреннего цикла одна цепочка переносов.
+    constexpr BigUInt<N> mul(const BigUInt<N>& a, const BigUInt<N>& b) const {
+        uint64_t t[2 * N] = {};
+        for (size_t i = 0; i < N; ++i) {
+            uint64_t c = 0, bi = b.limb[i];
+            for (size_t j = 0; j < N; ++j) {
+                unsigned __int128 x = (unsigned __int128)a.limb[j] * bi + t[i + j] + c;
+                t[i + j] = (uint64_t)x;
+                c = (uint64_t)(x >> 64);
+            }
+            t[i + N] = c;
+        }
+        return redc(t);
+    }
+
+    // a^2 * R^(-1) mod m: перекрёстные произведения считаются один раз и удваиваются
+    constexpr BigUInt<N> sqr(const BigUInt<N>& a) const {
+        uint64_t t[2 * N] = {};
+        for (size_t i = 0; i < N; ++i) {
+            uint64_t c = 0, ai = a.limb[i];
+            for (size_t j = i + 1; j < N; ++j) {
+                unsigned __int128 x = (unsigned __int128)a.limb[j] * ai + t[i + j] + c;
+                t[i + j] = (uint64_t)x;
+                c = (uint64_t)(x >> 64);
+            }
+            t[i + N] = c;
+        }
+        uint64_t c = 0;
+        for (size_t i = 0; i < 2 * N; ++i) {
+            uint64_t v = t[i];
+            t[i] = (v << 1) | c;
+            c = v >> 63;
+        }
+        c = 0;
+        for (size_t i = 0; i < N; ++i) {
+            unsigned __int128 d = (unsigned __int128)a.limb[i] * a.limb[i];
+            unsigned __int128 x = (unsigned __int128)t[2 * i] + (uint64_t)d + c;
+            t[2 * i] = (uint64_t)x;
+            x = (unsigned __int128)t[2 * i + 1] + (uint64_t)(d >> 64) + (uint64_t)(x >> 64);
+            t[2 * i + 1] = (uint64_t)x;
+            c = (uint64_t)(x >> 64);
+        }
+        return redc(t);
+    }
+
+    constexpr BigUInt<N> to_mont(const BigUInt<N>& a) const { return mul(a, r2_); }
+    constexpr BigUInt<N> from_mont(const BigUInt<N>& a) const { return mul(a, BigUInt<N>::from_u64(1)); }
+
+    // a * b mod m в обычном представлении
+    constexpr BigUInt<N> mul_mod(const BigUInt<N>& a, const BigUInt<N>& b) const { return mul(mul(a, b), r2_); }
+
+    // x mod m для x произвольной ширины: схема Горнера по блокам из N слов,
+    // каждый шаг — два умножения Монтгомери вместо побитового деления
+    template <size_t M>
+    BigUInt<N> reduce(const BigUInt<M>& x) const {
+        constexpr size_t chunks = (M + N - 1) / N;
+        BigUInt<N> acc; // acc * R mod m
+        for (size_t c = chunks; c-- > 0;) {
+            BigUInt<N> chunk;
+            for (size_t i = 0; i < N && c * N + i < M; ++i) chunk.limb[i] = x.limb[c * N + i];
+            acc = add_mod(mul(acc, r2_), mul(chunk, r2_), m_);
+        }
+        return from_mont(acc);
+    }
+
+    // base^exp mod m, окно фиксированной ширины 4 бита; base и результат — в обычном представлении
+    template <size_t E>
+    BigUInt<N> pow(const BigUInt<N>& base, const BigUInt<E>& exp) const {
+        BigUInt<N> table[16];
+        table[0] = to_mont(BigUInt<N>::from_u64(1));
+        table[1] = to_mont(base);
+        for (int i = 2; i < 16; ++i) table[i] = mul(table[i - 1], table[1]);
+
+        BigUInt<N> acc = table[0];
+        size_t bits = (exp.bit_length() + 3) / 4 * 4;
+        for (size_t i = bits; i >= 4; i -= 4) {
+            if (i != bits) {
+                acc = sqr(acc);
+                acc = sqr(acc);
+                acc = sqr(acc);
+                acc = sqr(acc);
+            }
+            unsigned w = (unsigned)(exp.limb[(i - 4) / 64] >> ((i - 4) % 64)) & 0xF;
+            if (w) acc = mul(acc, table[w]);
+        }
+        return from_mont(acc);
+    }
+
+    // g^a * y^b mod m за один проход (приём Штрауса–Шамира): общая цепочка
+    // возведений в квадрат и совместная таблица g^i * y^j для окон по 2 бита
+    template <size_t E>
+    BigUInt<N> pow2(const BigUInt<N>& g, const BigUInt<E>& a,
+                    const BigUInt<N>& y, const BigUInt<E>& b) const {
+        BigUInt<N> table[16]; // table[i + 4j] = g^i * y^j
+        table[0] = to_mont(BigUInt<N>::from_u64(1));
+        table[1] = to_mont(g);
+        table[2] = sqr(table[1]);
+        table[3] = mul(table[2], table[1]);
+        table[4] = to_mont(y);
+        table[8] = sqr(table[4]);
+        table[12] = mul(table[8], table[4]);
+        for (int j = 4; j < 16; j += 4)
+            for (int i = 1; i < 4; ++i) table[i + j] = mul(table[i], table[j]);
+
+        BigUInt<N> acc = table[0];
+        size_t len = a.bit_length() > b.bit_length() ? a.bit_length() : b.bit_length();
+        size_t bits = (len + 1) / 2 * 2;
+        for (size_t i = bits; i >= 2; i -= 2) {
+            if (i != bits) {
+                acc = sqr(acc);
+                acc = sqr(acc);
+            }
+            size_t limb = (i - 2) / 64, shift = (i - 2) % 64;
+            unsigned w = (unsigned)((a.limb[limb] >> shift) & 3) | (unsigned)(((b.limb[limb] >> shift) & 3) << 2);
+            if (w) acc = mul(acc, table[w]);
+        }
+        return from_mont(acc);
+    }
+
+    // a^(-1) mod m для простого m (малая теорема Ферма)
+    BigUInt<N> inverse(const BigUInt<N>& a) const {
+        if (a.is_zero()) throw std::runtime_error("Montgomery::inverse: division by zero");
+        BigUInt<N> e;
+        sub(e, m_, BigUInt<N>::from_u64(2));
+        return pow(a, e);
+    }
+};
+
+// Предвычисленные степени фиксированного основания: base^(d * 16^w) для каждого
+// 4-битного окна w экспоненты из E слов. Возведение в степень — одно умножение
+// на ненулевую цифру, без возведений в квадрат. Таблица строится один раз на ключ
+// и только читается, поэтому её можно делить между потоками.
+template <size_t N, size_t E>
+class FixedBaseTable {
+private:
+    static constexpr size_t WINDOWS = E * 16;
+    const Montgomery<N>& mont_;
+    std::vector<BigUInt<N>> table_; // table_[w * 16 + d]
+
+public:
+    FixedBaseTable(const Montgomery<N>& mont, const BigUInt<N>& base)
+        : mont_(mont), table_(WINDOWS * 16) {
+        BigUInt<N> one = mont.to_mont(BigUInt<N>::from_u64(1));
+        BigUInt<N> cur = mont.to_mont(base);
+        for (size_t w = 0; w < WINDOWS; ++w) {
+            BigUInt<N>* row = &table_[w * 16];
+            row[0] = one;
+            row[1] = cur;
+            for (int d = 2; d < 16; ++d) row[d] = mont.mul(row[d - 1], cur);
+            cur = mont.mul(row[15], cur);
+        }
+    }
+
+    // base^exp в представлении Монтгомери
+    BigUInt<N> pow_mont(const BigUInt<E>& exp) const {
+        BigUInt<N> acc = table_[0];
+        for (size_t w = 0; w < WINDOWS; ++w) {
+            unsigned d = (unsigned)(exp.limb[w / 16] >> (4 * (w % 16))) & 0xF;
+            if (d) acc = mont_.mul(acc, table_[w * 16 + d]);
+        }
+        return acc;
+    }
+
+    // То же для секретного exp (k, x): умножение на каждом окне, включая нулевые,
+    // элемент строки выбирается маской из всех 16 — время и адреса не зависят от exp
+    BigUInt<N> pow_mont_ct(const BigUInt<E>& exp) const {
+        BigUInt<N> acc = table_[0];
+        for (size_t w = 0; w < WINDOWS; ++w) {
+            uint64_t d = (exp.limb[w / 16] >> (4 * (w % 16))) & 0xF;
+            const BigUInt<N>* row = &table_[w * 16];
+            BigUInt<N> t = row[0];
+            for (uint64_t j = 1; j < 16; ++j) t = ct_select(ct_eq_mask(j, d), row[j], t);
+            acc = mont_.mul(acc, t);
+        }
+        return acc;
+    }
+
+    BigUInt<N> pow_ct(const BigUInt<E>& exp) const { return mont_.from_mont(pow_mont_ct(exp)); }
+};
+
+// Компактная таблица фиксированного основания: только base^(16^w) для каждого окна w
+// (в E/4 раз меньше FixedBaseTable), возведение в степень — методом Яо:
+// около одного умножения на ненулевую цифру плюс 30 на проход по значениям цифр.
+// Таблицу можно сохранить в файл и восстановить без пересчёта.
+template <size_t N, size_t E>
+class FixedBasePowers {
+public:
+    static constexpr size_t WINDOWS = E * 16;
+
+private:
+    const Montgomery<N>* mont_ = nullptr;
+    std::vector<BigUInt<N>> powers_; // base^(16^w) в представлении Монтгомери
+
+public:
+    FixedBasePowers() = default;
+
+    FixedBasePowers(const Montgomery<N>& mont, const BigUInt<N>& base) : mont_(&mont), powers_(WINDOWS) {
+        powers_[0] = mont.to_mont(base);
+        for (size_t w = 1; w < WINDOWS; ++w) {
+            BigUInt<N> v = mont.sqr(powers_[w - 1]);
+            v = mont.sqr(v);
+            v = mont.sqr(v);
+            powers_[w] = mont.sqr(v);
+        }
+    }
+
+    FixedBasePowers(const Montgomery<N>& mont, std::vector<BigUInt<N>> powers)
+        : mont_(&mont), powers_(std::move(powers)) {
+        if (powers_.size() != WINDOWS) throw std::invalid_argument("FixedBasePowers: wrong table size");
+    }
+
+    bool empty() const { return powers_.empty(); }
+    const std::vector<BigUInt<N>>& powers() const { return powers_; }
+
+    // base^exp в представлении Монтгомери
+    BigUInt<N> pow_mont(const BigUInt<E>& exp) const {
+        BigUInt<N> one = mont_->to_mont(BigUInt<N>::from_u64(1));
+        BigUInt<N> acc = one, run = one;
+        bool run_used = false;
+        for (unsigned d = 15; d >= 1; --d) {
+            for (size_t w = 0; w < WINDOWS; ++w) {
+                if (((exp.limb[w / 16] >> (4 * (w % 16))) & 0xF) == d) {
+                    run = run_used ? mont_->mul(run, powers_[w]) : powers_[w];
+                    run_used = true;
+                }
+            }
+            if (run_used) acc = mont_->mul(acc, run);
+        }
+        return acc;
+    }
+
+    BigUInt<N> pow(const BigUInt<E>& exp) const { return mont_->from_mont(pow_mont(exp)); }
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Хеш файла по блокам: SHA-256 каждого блока фиксированного размера, затем
+// H = SHA-256("CHUNKS1" || размер блока || размер файла || хеши блоков).
+// Хеши блоков хранятся в файле-спутнике <file>.chunks вместе с метаданными файла
+// (устройство, inode, размер, mtime, ctime); если они не изменились, файл не читается.
+// Этот хеш не совпадает с sha256_file, поэтому подпись по нему проверяется тем же режимом.
+
+constexpr size_t CHUNK_SIZE = 4 << 20;
+
+struct ChunkDigestStats {
+    size_t chunks = 0;
+    size_t rehashed = 0; // сколько блоков пришлось прочитать и хешировать
+};
+
+// use_cache = false — все блоки читаются заново, файл-спутник не трогается (для проверки)
+std::vector<unsigned char> chunked_sha256_file(const std::string& filename, bool use_cache,
+                                               ChunkDigestStats* stats = nullptr);
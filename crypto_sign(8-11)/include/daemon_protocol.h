@@ -0,0 +1,123 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Протокол демона подписи (sign_daemon): текстовые строки через Unix-сокет.
+// Запросы можно отправлять подряд, не дожидаясь ответов (не больше MAX_IN_FLIGHT);
+// ответы приходят в том же порядке.
+//   SIGN FILE <path>               -> OK <подпись hex>
+//   SIGN DIGEST <hex>              -> OK <подпись hex>
+//   VERIFY FILE <path> <подпись>   -> OK VALID | OK INVALID
+//   VERIFY DIGEST <hex> <подпись>  -> OK VALID | OK INVALID
+//   PING                           -> OK PONG
+// Ошибка — "ERR <текст>". Подпись — те же байты, что в файле _sig (формат EGS1).
+// Путь к файлу читается демоном, поэтому он должен быть абсолютным или относительным к каталогу демона.
+
+static const char DEFAULT_SOCKET_PATH[] = "/tmp/sign_tool.sock";
+constexpr size_t MAX_REQUEST_LINE = 64 * 1024;
+// Сколько запросов одного соединения демон держит без ответа; дальше он перестаёт читать.
+// Клиент, который отправляет больше, не читая ответов, упрётся в заполненные буферы сокета.
+constexpr size_t MAX_IN_FLIGHT = 256;
+
+inline std::string bytes_to_hex(const std::vector<unsigned char>& data) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(data.size() * 2);
+    for (unsigned char b : data) {
+        out.push_back(digits[b >> 4]);
+        out.push_back(digits[b & 0xF]);
+    }
+    return out;
+}
+
+// false — нечётная длина или не hex-символ
+inline bool hex_to_bytes(const std::string& hex, std::vector<unsigned char>& out) {
+    if (hex.size() % 2 != 0) return false;
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    out.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = nibble(hex[i]), lo = nibble(hex[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.push_back(static_cast<unsigned char>(hi << 4 | lo));
+    }
+    return true;
+}
+
+inline sockaddr_un unix_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path is too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+inline int connect_unix(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    sockaddr_un addr = unix_address(path);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("Cannot connect to " + path + ": " + std::strerror(err));
+    }
+    return fd;
+}
+
+inline void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        }
+        sent += n;
+    }
+}
+
+// Чтение сокета построчно с собственным буфером
+class LineReader {
+private:
+    int fd_;
+    std::string buf_;
+    size_t pos_ = 0;
+
+public:
+    explicit LineReader(int fd) : fd_(fd) {}
+
+    // false — соединение закрыто; исключение — ошибка чтения или слишком длинная строка
+    bool next(std::string& line) {
+        for (;;) {
+            size_t eol = buf_.find('\n', pos_);
+            if (eol != std::string::npos) {
+                line.assign(buf_, pos_, eol - pos_);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                pos_ = eol + 1;
+                return true;
+            }
+            if (buf_.size() - pos_ > MAX_REQUEST_LINE) throw std::runtime_error("Line is too long");
+            buf_.erase(0, pos_);
+            pos_ = 0;
+
+            char chunk[16384];
+            ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("recv: ") + std::strerror(errno));
+            }
+            if (n == 0) return false;
+            buf_.append(chunk, n);
+        }
+    }
+};
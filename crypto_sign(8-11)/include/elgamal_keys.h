@@ -0,0 +1,50 @@
+#pragma once
+#include "bignum.h"
+#include <memory>
+#include <string>
+
+// Параметры и ключи Эль-Гамаля (1024 бита)
+
+using ElgInt = BigUInt<16>;
+using ElgPowers = FixedBasePowers<16, 16>;
+using ElgTable = FixedBaseTable<16, 16>;
+
+// Безопасное простое p = 2q + 1 и примитивный корень g
+struct ElGamalGroup {
+    ElgInt p, p1, q, g; // p1 = p - 1 = 2q
+    Montgomery<16> mont_p, mont_q;
+
+    ElGamalGroup();
+
+    // Арифметика по чётному модулю p - 1 = 2q: вычет по q (Монтгомери) плюс чётность (КТО)
+    ElgInt mul_mod_p1(const ElgInt& a, const ElgInt& b) const;
+    // k^(-1) mod (p - 1) для нечётного k, не кратного q
+    ElgInt inv_mod_p1(const ElgInt& k) const;
+};
+
+const ElGamalGroup& elgamal_group();
+
+// Полная таблица степеней g группы (512 КБ, строится при первом вызове) для g^k и g^x:
+// ElgPowers::pow пропускает нулевые окна и ветвится по цифрам, для секретов — только pow_ct
+const ElgTable& elgamal_g_table();
+
+// Случайное число 0 < result < max (OpenSSL RAND_bytes)
+ElgInt elgamal_random_below(const ElgInt& max);
+
+struct ElGamalKey {
+    ElgInt p, g, x, y;
+    bool has_private = false;
+    ElgPowers table_g, table_y; // степени g^(16^w) и y^(16^w) для быстрого возведения
+};
+
+// Новый ключ в группе elgamal_group() вместе с таблицами
+ElGamalKey generate_elgamal_key();
+
+// Двоичные файлы ключей: заголовок, p, g, y, (x), таблицы g и y.
+// Закрытый ключ содержит и открытую часть.
+void save_elgamal_key_files(const ElGamalKey& key, const std::string& priv_path, const std::string& pub_path);
+
+// Ключ из файла (двоичный формат или текстовый открытый ELG1) с кешем в памяти процесса:
+// повторный вызов для того же пути с тем же mtime и размером не читает файл.
+// nullptr — файла нет или он в старом десятичном формате.
+std::shared_ptr<const ElGamalKey> load_elgamal_key_cached(const std::string& path);
@@ -1,5 +1,43 @@
 #pragma once
+#include "elgamal_keys.h"
 #include <string>
+#include <vector>
+
+struct ElGamalSignature {
+    ElgInt r, s;
+};
+
+// Подпись и проверка хеша целиком, без работы с файлами и без вывода: их вызывают
+// и потоки демона, поэтому сообщения о причине отказа печатает только sign_tool
+enum class ElGamalVerifyStatus { VALID, INVALID, UNSUPPORTED_KEY, BAD_BOUNDS };
+
+ElGamalSignature elgamal_sign_digest(const std::vector<unsigned char>& hash, const ElGamalKey& key);
+ElGamalVerifyStatus elgamal_check_digest(const std::vector<unsigned char>& hash, const ElGamalSignature& sig,
+                                         const ElGamalKey& key);
+bool elgamal_verify_digest(const std::vector<unsigned char>& hash, const ElGamalSignature& sig,
+                           const ElGamalKey& key);
+const char* elgamal_verify_status_text(ElGamalVerifyStatus status);
+
+// Подпись в файле: "EGS1", длины r и s, затем r и s little-endian
+std::vector<unsigned char> elgamal_encode_signature(const ElGamalSignature& sig);
+bool elgamal_is_digest_signature(const std::vector<unsigned char>& raw);
+// false — не подпись нового формата или повреждённый файл
+bool elgamal_decode_signature(const std::vector<unsigned char>& raw, ElGamalSignature& sig);
+
+// Ключ из elgamal_priv.key (через кеш процесса); если его нет — создаётся и сохраняется,
+// а прежняя пара ключей переносится в *.legacy (десятичная) или *.1, *.2, ...
+std::shared_ptr<const ElGamalKey> elgamal_signing_key();
 
 void elgamal_sign_file(const std::string& filename);
-void elgamal_verify_file(const std::string& filename);
\ No newline at end of file
+void elgamal_verify_file(const std::string& filename);
+
+// Подпись хеша по блокам (chunk_digest.h): при повторной подписи неизменённого файла
+// хеши блоков берутся из <file>.chunks. Проверка всегда читает файл целиком.
+void elgamal_sign_file_chunked(const std::string& filename);
+void elgamal_verify_file_chunked(const std::string& filename);
+
+// Потоковый режим: данные читаются из stdin и без изменений передаются в stdout,
+// подпись пишется в отдельный файл sig_path. Журнал в этом режиме идёт в stderr.
+void elgamal_sign_stream(const std::string& sig_path);
+// false — подпись не сошлась (данные к этому моменту уже переданы дальше)
+bool elgamal_verify_stream(const std::string& sig_path);
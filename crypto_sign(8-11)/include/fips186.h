@@ -2,34 +2,54 @@
 #include <string>
 #include <vector>
 #include <utility>
-#include <cstdint>
+#include "batch_verify.h"
+#include "modint.h"
+#include "presign_pool.h"
+#include <memory>
 
 class FIPS186 {
-private:
-    std::vector<unsigned char> p, q, g; // параметры
-    std::vector<unsigned char> x; // секретный ключ
-    std::vector<unsigned char> y; // публичный ключ
-
-    static uint64_t to_uint64(const std::vector<unsigned char>& v);
-    static std::vector<unsigned char> from_uint64(uint64_t n);
-
-    static uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t mod);
-    static uint64_t mod_exp(uint64_t base, uint64_t exp, uint64_t mod);
-    static uint64_t mod_inv(uint64_t a, uint64_t mod);
+public:
+    // Учебные параметры шириной до 64 бит: p — 64 бита, q — 48 бит, q | (p-1)
+    using ModP = ModInt<64>;
+    using ModQ = ModInt<48>;
+    using IntP = ModP::Int;
+    using IntQ = ModQ::Int;
 
-    std::vector<unsigned char> random_number(const std::vector<unsigned char>& max);
-    bool is_zero(const std::vector<unsigned char>& n);
-    bool less(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b);
+private:
+    ModP mod_p;
+    ModQ mod_q;
+    IntP g;
+    IntQ x; // секретный ключ
+    IntP y; // публичный ключ
+
+    // Заготовка подписи: k, r = (g^k mod p) mod q и k^{-1} mod q
+    struct Presig {
+        IntQ k, r, k_inv;
+    };
+    std::unique_ptr<PresignPool<Presig>> presign;
+    Presig make_presig();
+
+    IntQ hash_to_q(const std::vector<unsigned char>& message_hash) const;
+    bool verify_exponents(const std::vector<unsigned char>& message_hash, const SignaturePair& signature,
+                          IntQ& r, IntQ& u1, IntQ& u2) const;
 
 public:
     FIPS186();
 
     void generate_keys(); // генерирует x и y
+    // Режим offline/online: фоновый поток заранее считает (k, r, k^{-1}),
+    // и sign выполняет только дешёвое вычисление s. sign можно вызывать из нескольких
+    // потоков (каждая заготовка достаётся одному), start/stop — только когда sign не идёт
+    void start_precompute(size_t capacity = 1024);
+    void stop_precompute();
     std::pair<std::vector<unsigned char>, std::vector<unsigned char>>
       sign(const std::vector<unsigned char>& message_hash); // возвращает (r, s)
     bool verify(const std::vector<unsigned char>& message_hash,
                 const std::pair<std::vector<unsigned char>, std::vector<unsigned char>>& signature);
 
+    // Проверка N подписей одним ключом: общие таблицы степеней g и y, потоки из parallel_for
+    BatchResult verify_batch(const std::vector<BatchItem>& items, unsigned threads = 0) const;
+
     void save_signature(const std::pair<std::vector<unsigned char>, std::vector<unsigned char>>& signature,
                         const std::string& filename);
     std::pair<std::vector<unsigned char>, std::vector<unsigned char>>
@@ -38,3 +58,5 @@ public:
 
 // Утилитная функция, похожая на gost_sign.h интерфейс
 void fips_sign_and_verify_file(const std::string& filename);
+// Подписывает несколько файлов одним ключом и проверяет подписи пакетом
+void fips_sign_and_verify_files(const std::vector<std::string>& filenames);
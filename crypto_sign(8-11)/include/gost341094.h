@@ -3,6 +3,10 @@
 #include <string>
 #include <utility>
 #include <cstdint>  // Добавлено для uint64_t
+#include "modint.h"
+#include "batch_verify.h"
+#include "presign_pool.h"
+#include <memory>
 
 // class GOST341094 {
 //     vector<unsigned char> p; // Большое простое число (модуль)
@@ -13,25 +17,51 @@
 // };
 
 class GOST341094 {
+public:
+    using ModP = ModInt<1024>; // p — 1024 бита
+    using ModQ = ModInt<256>;  // q — 256 бит
+    static constexpr size_t P_LIMBS = ModP::LIMBS;
+    static constexpr size_t Q_LIMBS = ModQ::LIMBS;
+    using IntP = ModP::Int;
+    using IntQ = ModQ::Int;
+
 private:
-    std::vector<unsigned char> p, q, a;
-    std::vector<unsigned char> d, c;
+    IntP p, a;
+    IntQ q;
+    IntQ d;
+    IntP c;
+    ModP mod_p;
+    ModQ mod_q;
+
+    // Заготовка подписи: случайное k и r = (a^k mod p) mod q
+    struct Presig {
+        IntQ k, r;
+    };
+    std::unique_ptr<PresignPool<Presig>> presign;
+    Presig make_presig();
 
     // Вспомогательные функции
-    std::vector<unsigned char> from_int(uint64_t n);
-    std::vector<unsigned char> random_number(const std::vector<unsigned char>& max);
-    bool is_zero(const std::vector<unsigned char>& n);
-    bool less(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b);
+    IntQ hash_to_q(const std::vector<unsigned char>& message_hash) const;
+    // Проверка границ r, s и вычисление показателей z1, z2; false — подпись заведомо неверна
+    bool verify_exponents(const std::vector<unsigned char>& message_hash, const SignaturePair& signature,
+                          IntQ& r, IntQ& z1, IntQ& z2) const;
     
 public:
     GOST341094();
     void generate_keys();
+    // Режим offline/online: фоновый поток заранее считает пары (k, r),
+    // и sign выполняет только дешёвое вычисление s. sign можно вызывать из нескольких
+    // потоков (каждая заготовка достаётся одному), start/stop — только когда sign не идёт
+    void start_precompute(size_t capacity = 1024);
+    void stop_precompute();
     std::pair<std::vector<unsigned char>, std::vector<unsigned char>> 
     sign(const std::vector<unsigned char>& message_hash);
     bool verify(const std::vector<unsigned char>& message_hash, 
                 const std::pair<std::vector<unsigned char>, std::vector<unsigned char>>& signature);
+    // Проверка N подписей одним ключом: общие таблицы степеней a и c, потоки из parallel_for
+    BatchResult verify_batch(const std::vector<BatchItem>& items, unsigned threads = 0) const;
     void save_signature(const std::pair<std::vector<unsigned char>, std::vector<unsigned char>>& signature, 
                        const std::string& filename);
     std::pair<std::vector<unsigned char>, std::vector<unsigned char>> 
     load_signature(const std::string& filename);
-};
\ No newline at end of file
+};
@@ -2,8 +2,12 @@
 #define GOST_SIGN_H
 
 #include <string>
+#include <vector>
 
 // Функция для подписи файла по ГОСТ Р 34.10-94
 void gost_sign_and_verify_file(const std::string& filename);
 
+// Подписывает несколько файлов одним ключом и проверяет подписи пакетом
+void gost_sign_and_verify_files(const std::vector<std::string>& filenames);
+
 #endif // GOST_SIGN_H
\ No newline at end of file
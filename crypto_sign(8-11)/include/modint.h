@@ -0,0 +1,89 @@
+#pragma once
+#include "bignum.h"
+#include <openssl/rand.h>
+#include <stdexcept>
+
+// Арифметика по нечётному модулю m шириной не более Bits бит — общая для FIPS 186 и ГОСТ.
+// Надстройка над Montgomery<(Bits + 63) / 64>: произведения слов берутся в 128 бит,
+// поэтому переполнения нет при любом m < 2^Bits, в том числе для 64-битных модулей.
+// Параметры (R^2 mod m, -m^(-1) mod 2^64) считаются в constexpr-конструкторе,
+// так что фиксированный модуль можно объявить constexpr-константой.
+// add, sub, neg и pow_ct не ветвятся по значениям — для секретных k, x, d.
+template <size_t Bits>
+class ModInt : public Montgomery<(Bits + 63) / 64> {
+public:
+    static constexpr size_t LIMBS = (Bits + 63) / 64;
+    using Int = BigUInt<LIMBS>;
+    using Base = Montgomery<LIMBS>;
+
+    constexpr explicit ModInt(const Int& modulus) : Base(modulus) {
+        if (modulus.bit_length() > Bits) throw std::invalid_argument("ModInt: modulus is wider than Bits");
+    }
+
+    // (a + b) mod m, при a, b < m
+    constexpr Int add(const Int& a, const Int& b) const {
+        Int r, d;
+        uint64_t carry = ::add(r, a, b);
+        uint64_t borrow = ::sub(d, r, this->modulus());
+        return ct_select(0 - (carry | (borrow ^ 1)), d, r);
+    }
+
+    // (a - b) mod m, при a, b < m
+    constexpr Int sub(const Int& a, const Int& b) const {
+        Int r, fix;
+        uint64_t mask = 0 - ::sub(r, a, b);
+        for (size_t i = 0; i < LIMBS; ++i) fix.limb[i] = this->modulus().limb[i] & mask;
+        ::add(r, r, fix);
+        return r;
+    }
+
+    constexpr Int neg(const Int& a) const { return sub(Int(), a); }
+
+    // base^exp mod m за фиксированное число операций: окно 4 бита по всей ширине exp,
+    // всегда одно умножение на окно, элемент таблицы выбирается маской из всех 16
+    template <size_t E>
+    Int pow_ct(const Int& base, const BigUInt<E>& exp) const {
+        Int table[16];
+        table[0] = this->to_mont(Int::from_u64(1));
+        table[1] = this->to_mont(base);
+        for (int i = 2; i < 16; ++i) table[i] = this->mul(table[i - 1], table[1]);
+
+        Int acc = table[0];
+        for (size_t i = E * 64; i >= 4; i -= 4) {
+            if (i != E * 64) {
+                acc = this->sqr(acc);
+                acc = this->sqr(acc);
+                acc = this->sqr(acc);
+                acc = this->sqr(acc);
+            }
+            uint64_t w = (exp.limb[(i - 4) / 64] >> ((i - 4) % 64)) & 0xF;
+            Int t = table[0];
+            for (uint64_t j = 1; j < 16; ++j) t = ct_select(ct_eq_mask(j, w), table[j], t);
+            acc = this->mul(acc, t);
+        }
+        return this->from_mont(acc);
+    }
+
+    // a^(-1) mod m для простого m, за фиксированное время
+    Int inverse_ct(const Int& a) const {
+        if (a.is_zero()) throw std::runtime_error("ModInt::inverse_ct: division by zero");
+        Int e;
+        ::sub(e, this->modulus(), Int::from_u64(2));
+        return pow_ct(a, e);
+    }
+
+    // Случайное 0 < result < m (OpenSSL RAND_bytes, отбраковка по маске старших бит)
+    Int random() const {
+        size_t bits = this->modulus().bit_length();
+        Int result;
+        do {
+            if (RAND_bytes(reinterpret_cast<unsigned char*>(result.limb), sizeof(result.limb)) != 1)
+                throw std::runtime_error("RAND_bytes failed");
+            for (size_t i = 0; i < LIMBS; ++i) {
+                if (bits <= i * 64) result.limb[i] = 0;
+                else if (bits < (i + 1) * 64) result.limb[i] &= (uint64_t(1) << (bits - i * 64)) - 1;
+            }
+        } while (!(result < this->modulus()) || result.is_zero());
+        return result;
+    }
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Выполняет fn(i) для всех i из [0, count) на threads потоках (0 — по числу ядер).
+// Индексы раздаются через общий атомарный счётчик, поэтому дорогие и дешёвые
+// элементы распределяются между потоками сами собой.
+template <typename F>
+void parallel_for(size_t count, unsigned threads, F fn) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (threads > count) threads = static_cast<unsigned>(count);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+    };
+    if (threads <= 1) {
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Кольцевой буфер заранее вычисленных заготовок подписи (k, r, ...) с фоновым
+// потоком-производителем. Производитель один и заполняет слоты без блокировок (двигает tail_);
+// потребителей может быть несколько — sign() вызывается из любых потоков, — поэтому
+// try_pop выполняется под мьютексом: иначе два потока могли бы забрать одно и то же k.
+// На полном буфере производитель спит на not_full_, пока try_pop не освободит слот.
+// Заготовки зависят только от параметров (p, q, g), но не от ключа.
+template <typename T>
+class PresignPool {
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex pop_mutex_; // потребители между собой и ожидание производителя
+    std::condition_variable not_full_;
+    std::function<T()> make_;
+    std::thread worker_;
+
+    void run() {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            size_t t = tail_.load(std::memory_order_relaxed);
+            if (t - head_.load(std::memory_order_acquire) == slots_.size()) {
+                std::unique_lock<std::mutex> lock(pop_mutex_);
+                not_full_.wait(lock, [&] {
+                    return stop_.load(std::memory_order_relaxed) ||
+                           t - head_.load(std::memory_order_relaxed) != slots_.size();
+                });
+                continue;
+            }
+            slots_[t & mask_] = make_();
+            tail_.store(t + 1, std::memory_order_release);
+        }
+    }
+
+public:
+    // capacity округляется вверх до степени двойки
+    PresignPool(size_t capacity, std::function<T()> make) : make_(std::move(make)) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots_.resize(n);
+        mask_ = n - 1;
+        worker_ = std::thread(&PresignPool::run, this);
+    }
+
+    ~PresignPool() {
+        {
+            std::lock_guard<std::mutex> lock(pop_mutex_);
+            stop_.store(true);
+        }
+        not_full_.notify_one();
+        worker_.join();
+        for (auto& slot : slots_) slot = T{};
+    }
+
+    PresignPool(const PresignPool&) = delete;
+    PresignPool& operator=(const PresignPool&) = delete;
+
+    // false — буфер пуст, заготовку нужно вычислить на месте
+    bool try_pop(T& out) {
+        bool was_full;
+        {
+            std::lock_guard<std::mutex> lock(pop_mutex_);
+            size_t h = head_.load(std::memory_order_relaxed);
+            size_t t = tail_.load(std::memory_order_acquire);
+            if (h == t) return false;
+            was_full = t - h == slots_.size();
+            out = slots_[h & mask_];
+            slots_[h & mask_] = T{}; // одноразовое k не задерживается в буфере
+            head_.store(h + 1, std::memory_order_release);
+        }
+        if (was_full) not_full_.notify_one(); // производитель ждёт только на полном буфере
+        return true;
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+};
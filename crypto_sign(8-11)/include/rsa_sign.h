@@ -1,6 +1,11 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <openssl/rsa.h>
+
+// Подпись каждого байта хеша отдельным блоком RSA_size(rsa) байт
+bool rsa_sign_hash(const std::vector<unsigned char>& hash, RSA* rsa, std::vector<unsigned char>& signature);
+bool rsa_verify_hash(const std::vector<unsigned char>& hash, const std::vector<unsigned char>& signature, RSA* rsa);
 
 void rsa_sign_file(const std::string& filename);
 void rsa_verify_file(const std::string& filename);
\ No newline at end of file
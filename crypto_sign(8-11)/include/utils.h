@@ -3,5 +3,8 @@
 #include <vector>
 
 std::vector<unsigned char> sha256_file(const std::string& filename);
+// SHA-256 потока из дескриптора in_fd до EOF; если tee_fd >= 0, данные по мере чтения
+// дописываются в него (stdin -> stdout в конвейере)
+std::vector<unsigned char> sha256_stream(int in_fd, int tee_fd);
 void write_file(const std::string& filename, const std::vector<unsigned char>& data);
 std::vector<unsigned char> read_file(const std::string& filename);
\ No newline at end of file
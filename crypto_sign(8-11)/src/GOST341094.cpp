@@ -1,155 +1,99 @@
 #include "gost341094.h"
-#include <random>
+#include "parallel.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <chrono>
 
 using namespace std;
 
-static uint64_t to_uint64(const std::vector<unsigned char>& v) {
-    if (v.empty()) return 0;
-    uint64_t res = 0;
-    for (int i = v.size() - 1; i >= 0; --i) {
-        res = (res << 8) | v[i];
-    }
-    return res;
-}
-
-static std::vector<unsigned char> from_uint64(uint64_t n) {
-    std::vector<unsigned char> result;
-    if (n == 0) {
-        result.push_back(0);
-        return result;
-    }
-    while (n > 0) {
-        result.push_back(static_cast<unsigned char>(n & 0xFF));
-        n >>= 8;
-    }
-    return result;
-}
-
-static uint64_t mod_mul(uint64_t a, uint64_t b, uint64_t mod) {
-    return (a * b) % mod;
-}
-
-static uint64_t mod_exp(uint64_t base, uint64_t exp, uint64_t mod) {
-    if (mod == 1) return 0;
-    uint64_t result = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1) {
-            result = mod_mul(result, base, mod);
-        }
-        base = mod_mul(base, base, mod);
-        exp >>= 1;
-    }
-    return result;
-}
-
-// Расширенный алгоритм Евклида для нахождения обратного по модулю
-static uint64_t mod_inv(uint64_t a, uint64_t mod) {
-    a %= mod;
-    if (a == 0) throw std::runtime_error("mod_inv: division by zero");
-    
-    int64_t x0 = 0, x1 = 1, r0 = mod, r1 = a;
-    while (r1 != 0) {
-        int64_t q = r0 / r1;
-        int64_t tmp = r1;
-        r1 = r0 - q * r1;
-        r0 = tmp;
-        
-        tmp = x1;
-        x1 = x0 - q * x1;
-        x0 = tmp;
-    }
-    
-    if (r0 != 1) throw std::runtime_error("mod_inv: no inverse");
-    if (x0 < 0) x0 += mod;
-    return static_cast<uint64_t>(x0);
-}
-
-GOST341094::GOST341094() {
-    p = from_uint64(1279); // Простое число
-    q = from_uint64(71);   // Простой делитель (p-1)
-    a = from_uint64(34);    // Образующий элемент a^q mod p = 1
-}
-
-bool GOST341094::is_zero(const vector<unsigned char>& n) {
-    for (auto byte : n) {
-        if (byte != 0) return false;
-    }
-    return true;
-}
-
-bool GOST341094::less(const vector<unsigned char>& a, const vector<unsigned char>& b) {
-    if (a.size() != b.size()) return a.size() < b.size();
-    for (int i = a.size() - 1; i >= 0; i--) {
-        if (a[i] != b[i]) return a[i] < b[i];
-    }
-    return false;
-}
-
-vector<unsigned char> GOST341094::random_number(const vector<unsigned char>& max) {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<unsigned char> dis(0, 255);
-    
-    vector<unsigned char> result(max.size());
-    do {
-        for (size_t i = 0; i < max.size(); i++) {
-            result[i] = dis(gen);
-        }
-    } while (!less(result, max) || is_zero(result));
-    
-    return result;
+// Параметры: p — 1024 бита, q — 256 бит, q | (p-1), a^q mod p = 1
+static constexpr char GOST_P_HEX[] =
+    "80e343d90da31b60bd371cbce952e306e2c5c3dd446da86ed783fe00cec2b027"
+    "ff7d48be105fddd766efe5538ef23eb3e7e1fd307eb8bd7640e9350d4a229ddc"
+    "094b0f751c4ade656536761be81a72d259861ef5d8a8cc305dac8d5f0b02ab5f"
+    "4ee8f6e472dfc89b095fbd3909480a653b62716ca394a54937cf88cd771bfc37";
+static constexpr char GOST_Q_HEX[] =
+    "ba6cb44edc9cead21df27c3a5e7fc51c595aa7b1fdb843de02000766bbdc69eb";
+static constexpr char GOST_A_HEX[] =
+    "330f995f20087127c1fc838433766f951f7faf3b24b08701e498a84ea14a35d1"
+    "67ddb2a3b72e02fea5fb7682e43619958b44123ab764a1ea3d8fc311ac1253c2"
+    "c8e9f413bf57d90a00064a7d2ba323313e6b16979a55dd57c4bfe1a54c50def8"
+    "a51ebee2c9c47e9f0f4f7e7fdd12d29ea8c114fdc83e125bbda881cd84f22d2d";
+
+// Константы Монтгомери для p и q считаются при компиляции
+static constexpr GOST341094::ModP GOST_MOD_P(GOST341094::IntP::from_hex(GOST_P_HEX));
+static constexpr GOST341094::ModQ GOST_MOD_Q(GOST341094::IntQ::from_hex(GOST_Q_HEX));
+
+GOST341094::GOST341094()
+    : p(GOST_MOD_P.modulus()),
+      a(IntP::from_hex(GOST_A_HEX)),
+      q(GOST_MOD_Q.modulus()),
+      mod_p(GOST_MOD_P),
+      mod_q(GOST_MOD_Q) {}
+
+// h = hash(message) mod q (если h=0, то h=1); хеш используется целиком
+GOST341094::IntQ GOST341094::hash_to_q(const vector<unsigned char>& message_hash) const {
+    IntQ h = mod_q.reduce(IntQ::from_bytes(message_hash));
+    if (h.is_zero()) h = IntQ::from_u64(1);
+    return h;
 }
 
 // Генерирует случайный закрытый ключ d (1 < d < q)
 // Вычисляет открытый ключ: c = a^d mod p
 // Проверяет корректность: c^q mod p == 1
 void GOST341094::generate_keys() {
-    d = random_number(q);
-    uint64_t d_val = to_uint64(d);
-    uint64_t p_val = to_uint64(p);
-    uint64_t a_val = to_uint64(a);
-    uint64_t y_val = mod_exp(a_val, d_val, p_val);
+    d = mod_q.random();
+    IntP y = mod_p.pow_ct(a, d);
     
     // Проверка: y^q mod p == 1
-    uint64_t check = mod_exp(y_val, to_uint64(q), p_val);
-    if (check != 1) {
+    if (mod_p.pow(y, q) != IntP::from_u64(1)) {
         throw std::runtime_error("Invalid public key: y^q mod p != 1");
     }
     
-    c = from_uint64(y_val);
+    c = y;
+}
+
+// Случайное k и r = (a^k mod p) mod q, r != 0 — самая дорогая часть подписи
+GOST341094::Presig GOST341094::make_presig() {
+    Presig pre;
+    do {
+        pre.k = mod_q.random();
+        pre.r = mod_q.reduce(mod_p.pow_ct(a, pre.k));
+    } while (pre.r.is_zero());
+    return pre;
+}
+
+void GOST341094::start_precompute(size_t capacity) {
+    presign.reset();
+    presign.reset(new PresignPool<Presig>(capacity, [this]() { return make_presig(); }));
+}
+
+void GOST341094::stop_precompute() {
+    presign.reset();
 }
 
 // Вычисляет h = hash(message) mod q (если h=0, то h=1)
-// Генерирует случайное k (1 < k < q)
+// Берёт заготовку (k, r) из буфера или генерирует случайное k (1 < k < q)
 // Вычисляет r = (a^k mod p) mod q
 // Вычисляет s = (k*h + d*r) mod q
 // Если r=0 или s=0, повторяет с новым k
 // Результат: пара (r, s) - цифровая подпись
 pair<vector<unsigned char>, vector<unsigned char>> 
 GOST341094::sign(const vector<unsigned char>& message_hash) {
-    uint64_t h = to_uint64(message_hash) % to_uint64(q);
-    if (h == 0) h = 1;
+    IntQ h = hash_to_q(message_hash);
 
-    uint64_t p_val = to_uint64(p);
-    uint64_t q_val = to_uint64(q);
-    uint64_t a_val = to_uint64(a);
-    uint64_t d_val = to_uint64(d);
-
-    uint64_t r = 0, s = 0, k = 0;
+    IntQ r, s;
     do {
-        k = to_uint64(random_number(q));
-        if (k == 0) continue;
+        Presig pre;
+        if (!presign || !presign->try_pop(pre)) pre = make_presig();
 
-        r = mod_exp(a_val, k, p_val) % q_val;
-        s = (k * h + d_val * r) % q_val;
+        r = pre.r;
+        s = mod_q.add(mod_q.mul_mod(pre.k, h), mod_q.mul_mod(d, r));
 
-    } while (r == 0 || s == 0);
+    } while (s.is_zero());
 
-    return make_pair(from_uint64(r), from_uint64(s));
+    return make_pair(r.to_bytes(), s.to_bytes());
 }
 
 // Проверяет: 0 < r < q и 0 < s < q
@@ -159,35 +103,58 @@ GOST341094::sign(const vector<unsigned char>& message_hash) {
 // Вычисляет z2 = (-r)*v mod q
 // Вычисляет u = (a^z1 * y^z2 mod p) mod q
 // Если u == r - подпись верна
-bool GOST341094::verify(const vector<unsigned char>& message_hash,
-                       const pair<vector<unsigned char>, vector<unsigned char>>& signature) {
-    uint64_t r = to_uint64(signature.first);
-    uint64_t s = to_uint64(signature.second);
-    uint64_t q_val = to_uint64(q);
+bool GOST341094::verify_exponents(const vector<unsigned char>& message_hash, const SignaturePair& signature,
+                                  IntQ& r, IntQ& z1, IntQ& z2) const {
+    if (signature.first.size() > Q_LIMBS * 8 || signature.second.size() > Q_LIMBS * 8) {
+        return false;
+    }
+    r = IntQ::from_bytes(signature.first);
+    IntQ s = IntQ::from_bytes(signature.second);
 
-    if (r == 0 || r >= q_val || s == 0 || s >= q_val) {
+    if (r.is_zero() || !(r < q) || s.is_zero() || !(s < q)) {
         return false;
     }
 
-    uint64_t h = to_uint64(message_hash) % q_val;
-    if (h == 0) h = 1;
+    IntQ h = hash_to_q(message_hash);
 
-    uint64_t p_val = to_uint64(p);
-    uint64_t a_val = to_uint64(a);
-    uint64_t y_val = to_uint64(c); // открытый ключ
+    IntQ v = mod_q.inverse(h);
+    z1 = mod_q.mul_mod(s, v);
+    z2 = mod_q.mul_mod(mod_q.neg(r), v);
+    return true;
+}
 
-    uint64_t v = mod_inv(h, q_val);
-    uint64_t z1 = (s * v) % q_val;
-    uint64_t z2 = ((q_val - r) * v) % q_val;  // -r mod q
+bool GOST341094::verify(const vector<unsigned char>& message_hash,
+                       const pair<vector<unsigned char>, vector<unsigned char>>& signature) {
+    IntQ r, z1, z2;
+    if (!verify_exponents(message_hash, signature, r, z1, z2)) return false;
 
-    uint64_t u1 = mod_exp(a_val, z1, p_val);
-    uint64_t u2 = mod_exp(y_val, z2, p_val);
-    uint64_t u = (u1 * u2) % p_val;
-    u %= q_val;
+    // a^z1 * c^z2 — одним совместным возведением в степень (c — открытый ключ)
+    IntQ u = mod_q.reduce(mod_p.pow2(a, z1, c, z2));
 
     return (u == r);
 }
 
+// Те же шаги, что и в verify, но a^z1 и c^z2 берутся из таблиц,
+// построенных один раз на весь пакет
+BatchResult GOST341094::verify_batch(const vector<BatchItem>& items, unsigned threads) const {
+    auto start = chrono::steady_clock::now();
+    FixedBaseTable<P_LIMBS, Q_LIMBS> table_a(mod_p, a), table_c(mod_p, c);
+
+    BatchResult result;
+    result.valid.assign(items.size(), 0);
+    parallel_for(items.size(), threads, [&](size_t i) {
+        IntQ r, z1, z2;
+        if (!verify_exponents(items[i].hash, items[i].signature, r, z1, z2)) return;
+        IntP u = mod_p.from_mont(mod_p.mul(table_a.pow_mont(z1), table_c.pow_mont(z2)));
+        result.valid[i] = (mod_q.reduce(u) == r);
+    });
+
+    for (auto ok : result.valid) result.valid_count += ok;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.per_second = result.seconds > 0 ? items.size() / result.seconds : 0;
+    return result;
+}
+
 void GOST341094::save_signature(const pair<vector<unsigned char>, vector<unsigned char>>& signature, 
                                const string& filename) {
     ofstream file(filename, ios::binary);
@@ -0,0 +1,319 @@
+// Замеры sign_tool по этапам: генерация ключей, хеширование, подпись и проверка
+// отдельно для каждого алгоритма, размера файла и числа потоков.
+// Результат — таблица в stdout и файлы CSV/JSON.
+#include "../include/rsa_sign.h"
+#include "../include/elgamal_sign.h"
+#include "../include/gost341094.h"
+#include "../include/fips186.h"
+#include "../include/utils.h"
+#include "../include/parallel.h"
+#include <openssl/rand.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct BenchRow {
+    string algo, op;
+    size_t size_bytes = 0; // 0 — операция над хешем, от размера файла не зависит
+    unsigned threads = 1;
+    size_t ops = 0;
+    double seconds = 0, ops_per_s = 0, p50_us = 0, p99_us = 0, bytes_per_s = 0;
+};
+
+// Один алгоритм: ключи создаются в prepare, остальные операции используют их
+struct AlgoBench {
+    string name;
+    function<void()> keygen;
+    function<void()> prepare;
+    function<void(const vector<unsigned char>&)> sign;
+    function<bool(const vector<unsigned char>&)> verify;
+};
+
+struct Options {
+    vector<string> algos = {"rsa", "elgamal", "gost", "fips"};
+    vector<size_t> sizes = {1 << 10, 1 << 20, 64 << 20};
+    vector<unsigned> threads = {1};
+    size_t iters = 100;
+    size_t keygen_iters = 5;
+    string csv_path = "bench.csv", json_path = "bench.json";
+};
+
+static vector<string> split(const string& s) {
+    vector<string> parts;
+    stringstream ss(s);
+    for (string item; getline(ss, item, ',');)
+        if (!item.empty()) parts.push_back(item);
+    return parts;
+}
+
+// 1K, 64M, 1G или число байт
+static size_t parse_size(const string& s) {
+    size_t pos = 0;
+    size_t value = stoull(s, &pos);
+    string suffix = s.substr(pos);
+    if (suffix.empty() || suffix == "B") return value;
+    if (suffix == "K" || suffix == "KB") return value << 10;
+    if (suffix == "M" || suffix == "MB") return value << 20;
+    if (suffix == "G" || suffix == "GB") return value << 30;
+    throw invalid_argument("Bad size: " + s);
+}
+
+static string format_size(size_t n) {
+    if (n >= (1u << 30) && n % (1u << 30) == 0) return to_string(n >> 30) + "G";
+    if (n >= (1u << 20) && n % (1u << 20) == 0) return to_string(n >> 20) + "M";
+    if (n >= (1u << 10) && n % (1u << 10) == 0) return to_string(n >> 10) + "K";
+    return to_string(n);
+}
+
+static Options parse_options(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) throw invalid_argument("Missing value for " + arg);
+        string value = argv[++i];
+        if (arg == "--algos") {
+            opt.algos = split(value);
+        } else if (arg == "--sizes") {
+            opt.sizes.clear();
+            for (const auto& s : split(value)) opt.sizes.push_back(parse_size(s));
+        } else if (arg == "--threads") {
+            opt.threads.clear();
+            for (const auto& s : split(value)) opt.threads.push_back(static_cast<unsigned>(stoul(s)));
+        } else if (arg == "--iters") {
+            opt.iters = stoull(value);
+        } else if (arg == "--keygen-iters") {
+            opt.keygen_iters = stoull(value);
+        } else if (arg == "--csv") {
+            opt.csv_path = value;
+        } else if (arg == "--json") {
+            opt.json_path = value;
+        } else {
+            throw invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return opt;
+}
+
+// Процентиль по ближайшему рангу
+static double percentile(const vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(ceil(p * sorted.size()));
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+// count вызовов fn(i) на threads потоках; задержка каждого вызова замеряется отдельно.
+// Исключение из рабочего потока пробрасывается после завершения всех потоков.
+template <typename F>
+static BenchRow measure(const string& algo, const string& op, size_t size_bytes, unsigned threads, size_t count,
+                        F fn) {
+    vector<double> latency(count);
+    mutex error_mutex;
+    exception_ptr error;
+    auto start = Clock::now();
+    parallel_for(count, threads, [&](size_t i) {
+        auto t0 = Clock::now();
+        try {
+            fn(i);
+        } catch (...) {
+            lock_guard<mutex> lock(error_mutex);
+            if (!error) error = current_exception();
+        }
+        latency[i] = chrono::duration<double, micro>(Clock::now() - t0).count();
+    });
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    if (error) rethrow_exception(error);
+    sort(latency.begin(), latency.end());
+
+    BenchRow row;
+    row.algo = algo;
+    row.op = op;
+    row.size_bytes = size_bytes;
+    row.threads = threads;
+    row.ops = count;
+    row.seconds = seconds;
+    row.ops_per_s = count / seconds;
+    row.p50_us = percentile(latency, 0.50);
+    row.p99_us = percentile(latency, 0.99);
+    row.bytes_per_s = size_bytes * row.ops_per_s;
+    return row;
+}
+
+static AlgoBench make_rsa() {
+    auto key = make_shared<RSA*>(nullptr);
+    auto sig = make_shared<vector<unsigned char>>();
+    AlgoBench b;
+    b.name = "rsa";
+    b.keygen = [] {
+        RSA* rsa = RSA_generate_key(2048, RSA_F4, nullptr, nullptr);
+        if (!rsa) throw runtime_error("RSA key generation failed");
+        RSA_free(rsa);
+    };
+    b.prepare = [key] {
+        // ключ живёт до конца процесса
+        *key = RSA_generate_key(2048, RSA_F4, nullptr, nullptr);
+        if (!*key) throw runtime_error("RSA key generation failed");
+    };
+    b.sign = [key, sig](const vector<unsigned char>& hash) {
+        vector<unsigned char> out;
+        if (!rsa_sign_hash(hash, *key, out)) throw runtime_error("RSA signing failed");
+        if (sig->empty()) *sig = out;
+    };
+    b.verify = [key, sig](const vector<unsigned char>& hash) { return rsa_verify_hash(hash, *sig, *key); };
+    return b;
+}
+
+static AlgoBench make_elgamal() {
+    auto key = make_shared<ElGamalKey>();
+    auto sig = make_shared<ElGamalSignature>();
+    AlgoBench b;
+    b.name = "elgamal";
+    b.keygen = [] { generate_elgamal_key(); };
+    b.prepare = [key] { *key = generate_elgamal_key(); };
+    b.sign = [key, sig](const vector<unsigned char>& hash) {
+        auto out = elgamal_sign_digest(hash, *key);
+        if (sig->r.is_zero()) *sig = out;
+    };
+    b.verify = [key, sig](const vector<unsigned char>& hash) { return elgamal_verify_digest(hash, *sig, *key); };
+    return b;
+}
+
+// ГОСТ и FIPS 186 устроены одинаково: объект с ключами, sign и verify
+template <typename Scheme>
+static AlgoBench make_scheme(const string& name) {
+    auto scheme = make_shared<Scheme>();
+    auto sig = make_shared<SignaturePair>();
+    AlgoBench b;
+    b.name = name;
+    b.keygen = [] {
+        Scheme s;
+        s.generate_keys();
+    };
+    b.prepare = [scheme] { scheme->generate_keys(); };
+    b.sign = [scheme, sig](const vector<unsigned char>& hash) {
+        auto out = scheme->sign(hash);
+        if (sig->first.empty()) *sig = out;
+    };
+    b.verify = [scheme, sig](const vector<unsigned char>& hash) { return scheme->verify(hash, *sig); };
+    return b;
+}
+
+static AlgoBench make_algo(const string& name) {
+    if (name == "rsa") return make_rsa();
+    if (name == "elgamal") return make_elgamal();
+    if (name == "gost") return make_scheme<GOST341094>("gost");
+    if (name == "fips") return make_scheme<FIPS186>("fips");
+    throw invalid_argument("Unknown algorithm: " + name);
+}
+
+// Временный файл со случайным содержимым, удаляется в деструкторе
+struct TempFile {
+    string path;
+    explicit TempFile(size_t size) : path("sign_bench_" + format_size(size) + ".bin") {
+        ofstream out(path, ios::binary);
+        if (!out) throw runtime_error("Cannot create " + path);
+        vector<unsigned char> chunk(1 << 20);
+        for (size_t left = size; left > 0;) {
+            size_t n = min(left, chunk.size());
+            RAND_bytes(chunk.data(), static_cast<int>(n));
+            out.write(reinterpret_cast<const char*>(chunk.data()), n);
+            left -= n;
+        }
+    }
+    ~TempFile() { remove(path.c_str()); }
+};
+
+static void print_row(const BenchRow& r) {
+    cout << left << setw(8) << r.algo << setw(8) << r.op << right << setw(6)
+         << (r.size_bytes ? format_size(r.size_bytes) : "-") << setw(4) << r.threads << setw(8) << r.ops << fixed
+         << setprecision(1) << setw(12) << r.ops_per_s << setw(12) << r.p50_us << setw(12) << r.p99_us
+         << setw(12) << setprecision(1) << r.bytes_per_s / (1 << 20) << endl;
+}
+
+static void write_csv(const string& path, const vector<BenchRow>& rows) {
+    ofstream out(path);
+    out << "algo,op,size_bytes,threads,ops,seconds,ops_per_s,p50_us,p99_us,bytes_per_s\n";
+    out << setprecision(6);
+    for (const auto& r : rows)
+        out << r.algo << ',' << r.op << ',' << r.size_bytes << ',' << r.threads << ',' << r.ops << ','
+            << r.seconds << ',' << r.ops_per_s << ',' << r.p50_us << ',' << r.p99_us << ',' << r.bytes_per_s
+            << '\n';
+}
+
+static void write_json(const string& path, const vector<BenchRow>& rows) {
+    ofstream out(path);
+    out << "[\n" << setprecision(6);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& r = rows[i];
+        out << "  {\"algo\": \"" << r.algo << "\", \"op\": \"" << r.op << "\", \"size_bytes\": " << r.size_bytes
+            << ", \"threads\": " << r.threads << ", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_s\": " << r.ops_per_s << ", \"p50_us\": " << r.p50_us << ", \"p99_us\": " << r.p99_us
+            << ", \"bytes_per_s\": " << r.bytes_per_s << "}" << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options opt = parse_options(argc, argv);
+        vector<BenchRow> rows;
+        auto add = [&](BenchRow row) {
+            print_row(row);
+            rows.push_back(move(row));
+        };
+
+        cout << left << setw(8) << "algo" << setw(8) << "op" << right << setw(6) << "size" << setw(4) << "thr"
+             << setw(8) << "ops" << setw(12) << "ops/s" << setw(12) << "p50 us" << setw(12) << "p99 us"
+             << setw(12) << "MB/s" << endl;
+
+        // Хеш (SHA-256) общий для всех алгоритмов, поэтому замеряется один раз на размер
+        const size_t hash_budget = size_t(256) << 20; // байт на один замер
+        for (size_t size : opt.sizes) {
+            TempFile file(size);
+            for (unsigned threads : opt.threads) {
+                size_t count = max<size_t>(threads, min(opt.iters, hash_budget / size));
+                add(measure("sha256", "hash", size, threads, count, [&](size_t) { sha256_file(file.path); }));
+            }
+        }
+
+        vector<unsigned char> hash(32);
+        RAND_bytes(hash.data(), static_cast<int>(hash.size()));
+        for (const auto& name : opt.algos) {
+            AlgoBench algo = make_algo(name);
+            algo.prepare();
+            algo.sign(hash); // первая подпись сохраняется для замеров проверки
+            if (!algo.verify(hash)) throw runtime_error(name + ": self-check failed");
+
+            for (unsigned threads : opt.threads) {
+                size_t keygen_count = max<size_t>(threads, opt.keygen_iters);
+                add(measure(name, "keygen", 0, threads, keygen_count, [&](size_t) { algo.keygen(); }));
+                add(measure(name, "sign", 0, threads, opt.iters, [&](size_t) { algo.sign(hash); }));
+                add(measure(name, "verify", 0, threads, opt.iters, [&](size_t) {
+                    if (!algo.verify(hash)) throw runtime_error(name + ": verification failed");
+                }));
+            }
+        }
+
+        write_csv(opt.csv_path, rows);
+        write_json(opt.json_path, rows);
+        cout << "Results saved to " << opt.csv_path << " and " << opt.json_path << endl;
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        cerr << "Usage: " << argv[0]
+             << " [--algos rsa,elgamal,gost,fips] [--sizes 1K,1M,1G] [--threads 1,4] [--iters N]"
+                " [--keygen-iters N] [--csv file] [--json file]\n";
+        return 1;
+    }
+    return 0;
+}
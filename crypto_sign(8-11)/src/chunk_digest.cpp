@@ -0,0 +1,159 @@
+#include "chunk_digest.h"
+#include "parallel.h"
+#include <openssl/sha.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char CHUNKS_MAGIC[4] = {'C', 'H', 'K', '1'};
+static const char ROOT_DOMAIN[] = "CHUNKS1";
+
+// Метаданные файла, по которым решается, можно ли доверять сохранённым хешам
+struct FileMeta {
+    uint64_t dev, ino, size;
+    int64_t mtime_ns, ctime_ns;
+
+    bool operator==(const FileMeta& o) const {
+        return dev == o.dev && ino == o.ino && size == o.size && mtime_ns == o.mtime_ns && ctime_ns == o.ctime_ns;
+    }
+};
+
+struct ChunksHeader {
+    char magic[4];
+    uint32_t chunk_size;
+    FileMeta meta;
+    uint64_t count;
+};
+
+// Запись о блоке в файле-спутнике
+struct ChunkEntry {
+    uint64_t offset;
+    uint64_t length;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+};
+
+static FileMeta file_meta(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) throw std::runtime_error(std::string("fstat: ") + std::strerror(errno));
+    FileMeta m;
+    m.dev = st.st_dev;
+    m.ino = st.st_ino;
+    m.size = st.st_size;
+    m.mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    m.ctime_ns = (int64_t)st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec;
+    return m;
+}
+
+// Хеши блоков из файла-спутника; false — его нет или он не соответствует файлу.
+// Смещения и длины записей сверяются с размером файла: подписывается то, что было
+// прочитано из файла, а не то, что записано в спутнике.
+static bool load_chunks(const std::string& path, const FileMeta& meta, std::vector<ChunkEntry>& entries) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    ChunksHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    size_t expected = (meta.size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (std::memcmp(h.magic, CHUNKS_MAGIC, 4) != 0 || h.chunk_size != CHUNK_SIZE || !(h.meta == meta) ||
+        h.count != expected)
+        return false;
+    entries.resize(expected);
+    if (!in.read(reinterpret_cast<char*>(entries.data()), expected * sizeof(ChunkEntry))) return false;
+    for (size_t i = 0; i < expected; ++i) {
+        uint64_t offset = uint64_t(i) * CHUNK_SIZE;
+        if (entries[i].offset != offset || entries[i].length != std::min<uint64_t>(CHUNK_SIZE, meta.size - offset))
+            return false;
+    }
+    return true;
+}
+
+// Запись через временный файл и rename, чтобы оборванная запись не оставила полуфайл
+static void save_chunks(const std::string& path, const FileMeta& meta, const std::vector<ChunkEntry>& entries) {
+    ChunksHeader h;
+    std::memcpy(h.magic, CHUNKS_MAGIC, 4);
+    h.chunk_size = CHUNK_SIZE;
+    h.meta = meta;
+    h.count = entries.size();
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ChunkEntry));
+        if (!out) throw std::runtime_error("Cannot write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) throw std::runtime_error("Cannot replace " + path);
+}
+
+static void hash_chunk(int fd, ChunkEntry& e) {
+    thread_local std::vector<unsigned char> buffer(CHUNK_SIZE);
+    size_t done = 0;
+    while (done < e.length) {
+        ssize_t n = pread(fd, buffer.data() + done, e.length - done, e.offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Cannot read chunk at offset " + std::to_string(e.offset));
+        done += n;
+    }
+    SHA256(buffer.data(), e.length, e.digest);
+}
+
+std::vector<unsigned char> chunked_sha256_file(const std::string& filename, bool use_cache, ChunkDigestStats* stats) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + filename);
+
+    std::vector<ChunkEntry> entries;
+    FileMeta meta;
+    size_t rehashed = 0;
+    try {
+        meta = file_meta(fd);
+        std::string sidecar = filename + ".chunks";
+        if (!use_cache || !load_chunks(sidecar, meta, entries)) {
+            entries.assign((meta.size + CHUNK_SIZE - 1) / CHUNK_SIZE, ChunkEntry{});
+            for (size_t i = 0; i < entries.size(); ++i) {
+                entries[i].offset = uint64_t(i) * CHUNK_SIZE;
+                entries[i].length = std::min<uint64_t>(CHUNK_SIZE, meta.size - entries[i].offset);
+            }
+            // Блоки независимы, поэтому хешируются параллельно
+            std::atomic<bool> read_error{false};
+            parallel_for(entries.size(), 0, [&](size_t i) {
+                try {
+                    hash_chunk(fd, entries[i]);
+                } catch (const std::exception&) {
+                    read_error = true;
+                }
+            });
+            if (read_error) throw std::runtime_error("Cannot read file: " + filename);
+            rehashed = entries.size();
+
+            if (!(file_meta(fd) == meta)) throw std::runtime_error("File changed while hashing: " + filename);
+            if (use_cache) save_chunks(sidecar, meta, entries);
+        }
+        close(fd);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, ROOT_DOMAIN, sizeof(ROOT_DOMAIN) - 1);
+    uint64_t chunk_size = CHUNK_SIZE, file_size = meta.size;
+    SHA256_Update(&ctx, &chunk_size, sizeof(chunk_size));
+    SHA256_Update(&ctx, &file_size, sizeof(file_size));
+    for (const auto& e : entries) SHA256_Update(&ctx, e.digest, sizeof(e.digest));
+
+    std::vector<unsigned char> hash(SHA256_DIGEST_LENGTH);
+    SHA256_Final(hash.data(), &ctx);
+    if (stats) {
+        stats->chunks = entries.size();
+        stats->rehashed = rehashed;
+    }
+    return hash;
+}
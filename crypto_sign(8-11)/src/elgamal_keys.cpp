@@ -0,0 +1,233 @@
+#include "elgamal_keys.h"
+#include "utils.h"
+#include <openssl/rand.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+// Безопасное простое p = 2q + 1 (q — простое), g = 5 — примитивный корень по модулю p
+static const char* ELGAMAL_P_HEX =
+    "b753e32b6c296240d3fb3c8d5d18f903372e1f4eb6e090fc45493bbbbdde8a64"
+    "75e2cbe8b76c7f647b6cfa8146246527295c19afb759868e11dcabef360efe33"
+    "2c2c66f4c6ccd2c101a947b267ba5aa32d6b3a9330592e602b5b81f62f739c91"
+    "d4ed82a19bf0dd1b8256c5ee1ac7336c4db2d7bd4a02aa6b83c3a95a1ff27b2f";
+static const uint64_t ELGAMAL_G = 5;
+
+// Текстовый формат ключей (hex, только чтение) и заголовок двоичного
+static const char TEXT_KEY_MAGIC[] = "ELG1";
+static const char BINARY_KEY_MAGIC[4] = {'E', 'L', 'G', 'B'};
+static const uint32_t KEY_FILE_VERSION = 1;
+static const uint32_t KEY_PRIVATE = 1;
+static const uint32_t KEY_TABLES = 2;
+
+struct KeyFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t limbs;
+    uint32_t flags;
+    uint32_t windows;
+    uint32_t reserved;
+};
+
+static ElgInt sub_one(const ElgInt& v) {
+    ElgInt r;
+    sub(r, v, ElgInt::from_u64(1));
+    return r;
+}
+
+static ElgInt half(const ElgInt& v) {
+    ElgInt r;
+    for (size_t i = 0; i < 16; ++i) r.limb[i] = (v.limb[i] >> 1) | (i + 1 < 16 ? v.limb[i + 1] << 63 : 0);
+    return r;
+}
+
+ElGamalGroup::ElGamalGroup()
+    : p(ElgInt::from_hex(ELGAMAL_P_HEX)),
+      p1(sub_one(p)),
+      q(half(p1)),
+      g(ElgInt::from_u64(ELGAMAL_G)),
+      mont_p(p),
+      mont_q(q) {}
+
+static ElgInt from_crt(ElgInt t, unsigned parity, const ElgInt& q) {
+    if ((t.limb[0] & 1) != parity) add(t, t, q);
+    return t;
+}
+
+ElgInt ElGamalGroup::mul_mod_p1(const ElgInt& a, const ElgInt& b) const {
+    ElgInt t = mont_q.mul_mod(mont_q.reduce(a), mont_q.reduce(b));
+    return from_crt(t, a.limb[0] & b.limb[0] & 1, q);
+}
+
+ElgInt ElGamalGroup::inv_mod_p1(const ElgInt& k) const {
+    return from_crt(mont_q.inverse(mont_q.reduce(k)), 1, q);
+}
+
+const ElGamalGroup& elgamal_group() {
+    static const ElGamalGroup group;
+    return group;
+}
+
+const ElgTable& elgamal_g_table() {
+    static const ElgTable table(elgamal_group().mont_p, elgamal_group().g);
+    return table;
+}
+
+ElgInt elgamal_random_below(const ElgInt& max) {
+    size_t bits = max.bit_length();
+    ElgInt result;
+    do {
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(result.limb), sizeof(result.limb)) != 1)
+            throw std::runtime_error("RAND_bytes failed");
+        for (size_t i = 0; i < 16; ++i) {
+            if (bits <= i * 64) result.limb[i] = 0;
+            else if (bits < (i + 1) * 64) result.limb[i] &= (uint64_t(1) << (bits - i * 64)) - 1;
+        }
+    } while (!(result < max) || result.is_zero());
+    return result;
+}
+
+ElGamalKey generate_elgamal_key() {
+    const ElGamalGroup& grp = elgamal_group();
+    ElGamalKey key;
+    key.p = grp.p;
+    key.g = grp.g;
+    key.table_g = ElgPowers(grp.mont_p, key.g);
+    key.x = elgamal_random_below(grp.p1);
+    key.y = elgamal_g_table().pow_ct(key.x);
+    key.table_y = ElgPowers(grp.mont_p, key.y);
+    key.has_private = true;
+    return key;
+}
+
+// ===== Запись =====
+
+static void put_int(std::vector<unsigned char>& out, const ElgInt& v) {
+    const unsigned char* raw = reinterpret_cast<const unsigned char*>(v.limb);
+    out.insert(out.end(), raw, raw + sizeof(v.limb));
+}
+
+static std::vector<unsigned char> encode_key(const ElGamalKey& key, bool with_private) {
+    KeyFileHeader hdr{};
+    std::memcpy(hdr.magic, BINARY_KEY_MAGIC, 4);
+    hdr.version = KEY_FILE_VERSION;
+    hdr.limbs = 16;
+    hdr.flags = KEY_TABLES | (with_private ? KEY_PRIVATE : 0);
+    hdr.windows = ElgPowers::WINDOWS;
+
+    std::vector<unsigned char> out(reinterpret_cast<const unsigned char*>(&hdr),
+                                   reinterpret_cast<const unsigned char*>(&hdr) + sizeof(hdr));
+    put_int(out, key.p);
+    put_int(out, key.g);
+    put_int(out, key.y);
+    if (with_private) put_int(out, key.x);
+    for (const auto& v : key.table_g.powers()) put_int(out, v);
+    for (const auto& v : key.table_y.powers()) put_int(out, v);
+    return out;
+}
+
+void save_elgamal_key_files(const ElGamalKey& key, const std::string& priv_path, const std::string& pub_path) {
+    write_file(priv_path, encode_key(key, true));
+    write_file(pub_path, encode_key(key, false));
+}
+
+// ===== Чтение =====
+
+static ElgInt get_int(const std::vector<unsigned char>& raw, size_t& pos) {
+    ElgInt v;
+    if (pos + sizeof(v.limb) > raw.size()) throw std::runtime_error("Key file is truncated");
+    std::memcpy(v.limb, raw.data() + pos, sizeof(v.limb));
+    pos += sizeof(v.limb);
+    return v;
+}
+
+static std::vector<ElgInt> get_table(const std::vector<unsigned char>& raw, size_t& pos) {
+    std::vector<ElgInt> table(ElgPowers::WINDOWS);
+    for (auto& v : table) v = get_int(raw, pos);
+    return table;
+}
+
+static ElGamalKey decode_binary_key(const std::vector<unsigned char>& raw) {
+    const ElGamalGroup& grp = elgamal_group();
+    KeyFileHeader hdr;
+    if (raw.size() < sizeof(hdr)) throw std::runtime_error("Key file is truncated");
+    std::memcpy(&hdr, raw.data(), sizeof(hdr));
+    if (hdr.version != KEY_FILE_VERSION || hdr.limbs != 16)
+        throw std::runtime_error("Unsupported ElGamal key file version");
+
+    size_t pos = sizeof(hdr);
+    ElGamalKey key;
+    key.p = get_int(raw, pos);
+    key.g = get_int(raw, pos);
+    key.y = get_int(raw, pos);
+    if (hdr.flags & KEY_PRIVATE) {
+        key.x = get_int(raw, pos);
+        key.has_private = true;
+    }
+    if (key.p != grp.p) throw std::runtime_error("Key uses unsupported ElGamal parameters");
+
+    // Таблицы хранятся в представлении Монтгомери по p; первая запись — само основание
+    if ((hdr.flags & KEY_TABLES) && hdr.windows == ElgPowers::WINDOWS) {
+        key.table_g = ElgPowers(grp.mont_p, get_table(raw, pos));
+        key.table_y = ElgPowers(grp.mont_p, get_table(raw, pos));
+        if (key.table_g.powers()[0] != grp.mont_p.to_mont(key.g) ||
+            key.table_y.powers()[0] != grp.mont_p.to_mont(key.y))
+            throw std::runtime_error("Key file tables do not match the key");
+    } else {
+        key.table_g = ElgPowers(grp.mont_p, key.g);
+        key.table_y = ElgPowers(grp.mont_p, key.y);
+    }
+    return key;
+}
+
+// Текстовый открытый ключ "ELG1 p g y" (hex) из предыдущей версии формата.
+// Закрытые ключи в тексте не читаются: для подписи создаётся новый двоичный ключ.
+static bool decode_text_pub_key(const std::string& path, ElGamalKey& key) {
+    const ElGamalGroup& grp = elgamal_group();
+    std::ifstream in(path);
+    std::string magic, p, g, y;
+    in >> magic;
+    if (magic != TEXT_KEY_MAGIC) return false;
+    in >> p >> g >> y;
+    key.p = ElgInt::from_hex(p.c_str());
+    key.g = ElgInt::from_hex(g.c_str());
+    key.y = ElgInt::from_hex(y.c_str());
+    if (key.p != grp.p) throw std::runtime_error("Key uses unsupported ElGamal parameters");
+    key.table_g = ElgPowers(grp.mont_p, key.g);
+    key.table_y = ElgPowers(grp.mont_p, key.y);
+    return true;
+}
+
+struct CachedKey {
+    long long mtime_ns;
+    long long size;
+    std::shared_ptr<const ElGamalKey> key;
+};
+
+std::shared_ptr<const ElGamalKey> load_elgamal_key_cached(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, CachedKey> cache;
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return nullptr;
+    long long mtime_ns = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(path);
+    if (it != cache.end() && it->second.mtime_ns == mtime_ns && it->second.size == (long long)st.st_size) {
+        return it->second.key;
+    }
+
+    auto raw = read_file(path);
+    auto key = std::make_shared<ElGamalKey>();
+    if (raw.size() >= 4 && std::memcmp(raw.data(), BINARY_KEY_MAGIC, 4) == 0) {
+        *key = decode_binary_key(raw);
+    } else if (!decode_text_pub_key(path, *key)) {
+        return nullptr; // старый десятичный формат
+    }
+    cache[path] = {mtime_ns, (long long)st.st_size, key};
+    return key;
+}
@@ -1,277 +1,356 @@
 #include "elgamal_sign.h"
 #include "utils.h"
+#include "chunk_digest.h"
 #include <iostream>
 #include <fstream>
-#include <random>
 #include <vector>
-#include <cassert>
-#include <numeric>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using u64 = unsigned long long;
 using i64 = long long;
 
-// Простые функции
-u64 mod_exp(u64 base, u64 exp, u64 mod) {
-    u64 res = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1) res = (res * base) % mod;
-        base = (base * base) % mod;
-        exp >>= 1;
-    }
-    return res;
-}
+// ===== Подпись всего хеша одной парой (r, s) по модулю 1024-битного простого p =====
 
-u64 gcd(u64 a, u64 b) {
-    while (b != 0) {
-        u64 temp = b;
-        b = a % b;
-        a = temp;
-    }
-    return a;
+// Метка подписи нового формата; старые файлы её не содержат
+static const unsigned char SIG_MAGIC[4] = {'E', 'G', 'S', '1'};
+
+static const char PRIV_KEY_FILE[] = "elgamal_priv.key";
+static const char PUB_KEY_FILE[] = "elgamal_pub.key";
+// Прежние ключи при создании новых не перезаписываются: десятичные (побайтовые подписи)
+// переносятся в <файл>.legacy, двоичные и текстовые ELG1 — в <файл>.1, <файл>.2, ...
+static const char LEGACY_SUFFIX[] = ".legacy";
+
+static std::string legacy_path(const char* path) {
+    return std::string(path) + LEGACY_SUFFIX;
 }
 
-u64 mod_inv(u64 a, u64 m) {
-    i64 m0 = m, t, q;
-    i64 x0 = 0, x1 = 1;
-    
-    if (m == 1) return 0;
-    
-    while (a > 1) {
-        q = a / m;
-        t = m;
-        m = a % m;
-        a = t;
-        t = x0;
-        x0 = x1 - q * x0;
-        x1 = t;
-    }
-    
-    if (x1 < 0) x1 += m0;
-    return x1;
+static bool file_exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
 }
 
-// Генерация простого числа
-bool is_prime(u64 n) {
-    if (n < 2) return false;
-    if (n == 2 || n == 3) return true;
-    if (n % 2 == 0 || n % 3 == 0) return false;
-    
-    for (u64 i = 5; i * i <= n; i += 6) {
-        if (n % i == 0 || n % (i + 2) == 0) return false;
-    }
-    return true;
+// m = H(M) mod (p-1), один раз на весь хеш
+static ElgInt hash_to_exponent(const std::vector<unsigned char>& hash, const ElGamalGroup& grp) {
+    if (hash.size() > 16 * 8) throw std::invalid_argument("Hash is wider than p");
+    return mod_reduce(ElgInt::from_bytes(hash), grp.p1);
 }
 
-u64 find_prime(u64 min_val = 1000000) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<u64> dis(min_val, min_val + 1000000);
-    u64 p;
+// r = g^k mod p, s = k^(-1) * (m - x*r) mod (p-1), k взаимно просто с p-1 = 2q
+ElGamalSignature elgamal_sign_digest(const std::vector<unsigned char>& hash, const ElGamalKey& key) {
+    const ElGamalGroup& grp = elgamal_group();
+    if (key.g != grp.g) throw std::runtime_error("Key uses unsupported ElGamal parameters");
+    ElgInt m = hash_to_exponent(hash, grp);
+
+    ElGamalSignature sig;
     do {
-        p = dis(gen);
-    } while (!is_prime(p));
-    return p;
+        ElgInt k;
+        do {
+            k = elgamal_random_below(grp.p1);
+        } while (!(k.limb[0] & 1) || grp.mont_q.reduce(k).is_zero());
+
+        sig.r = elgamal_g_table().pow_ct(k);
+        ElgInt diff = sub_mod(m, grp.mul_mod_p1(key.x, sig.r), grp.p1);
+        sig.s = grp.mul_mod_p1(grp.inv_mod_p1(k), diff);
+    } while (sig.s.is_zero());
+    return sig;
 }
 
-// Найти примитивный корень по модулю p
-u64 find_primitive_root(u64 p) {
-    std::vector<u64> factors;
-    u64 phi = p - 1;
-    u64 n = phi;
-    
-    // Факторизуем phi = p-1
-    for (u64 i = 2; i * i <= n; ++i) {
-        if (n % i == 0) {
-            factors.push_back(i);
-            while (n % i == 0) n /= i;
-        }
-    }
-    if (n > 1) factors.push_back(n);
-    
-    // Ищем примитивный корень
-    for (u64 g = 2; g < p; ++g) {
-        bool ok = true;
-        for (u64 factor : factors) {
-            if (mod_exp(g, phi / factor, p) == 1) {
-                ok = false;
-                break;
-            }
-        }
-        if (ok) return g;
+// g^m ≡ y^r * r^s (mod p); g^m и y^r — по таблицам ключа, r^s — обычным возведением
+ElGamalVerifyStatus elgamal_check_digest(const std::vector<unsigned char>& hash, const ElGamalSignature& sig,
+                                         const ElGamalKey& key) {
+    const ElGamalGroup& grp = elgamal_group();
+    if (key.p != grp.p) return ElGamalVerifyStatus::UNSUPPORTED_KEY;
+    if (sig.r.is_zero() || !(sig.r < grp.p) || sig.s.is_zero() || !(sig.s < grp.p1))
+        return ElGamalVerifyStatus::BAD_BOUNDS;
+    ElgInt m = hash_to_exponent(hash, grp);
+    ElgInt left = key.table_g.pow(m);
+    ElgInt right = grp.mont_p.mul_mod(key.table_y.pow(sig.r), grp.mont_p.pow(sig.r, sig.s));
+    return left == right ? ElGamalVerifyStatus::VALID : ElGamalVerifyStatus::INVALID;
+}
+
+bool elgamal_verify_digest(const std::vector<unsigned char>& hash, const ElGamalSignature& sig,
+                           const ElGamalKey& key) {
+    return elgamal_check_digest(hash, sig, key) == ElGamalVerifyStatus::VALID;
+}
+
+const char* elgamal_verify_status_text(ElGamalVerifyStatus status) {
+    switch (status) {
+    case ElGamalVerifyStatus::VALID: return "Signature is valid";
+    case ElGamalVerifyStatus::INVALID: return "Signature does not match";
+    case ElGamalVerifyStatus::UNSUPPORTED_KEY: return "Public key uses unsupported parameters";
+    case ElGamalVerifyStatus::BAD_BOUNDS: return "Invalid signature bounds";
     }
-    return 2;
+    return "Unknown verification status";
 }
 
-struct ElGamalKey {
-    u64 p, g, x, y;
-};
+// Формат подписи: "EGS1", длины r и s (по байту), затем r и s little-endian
+std::vector<unsigned char> elgamal_encode_signature(const ElGamalSignature& sig) {
+    auto r = sig.r.to_bytes(), s = sig.s.to_bytes();
+    std::vector<unsigned char> out(SIG_MAGIC, SIG_MAGIC + 4);
+    out.push_back(static_cast<unsigned char>(r.size()));
+    out.push_back(static_cast<unsigned char>(s.size()));
+    out.insert(out.end(), r.begin(), r.end());
+    out.insert(out.end(), s.begin(), s.end());
+    return out;
+}
+
+bool elgamal_is_digest_signature(const std::vector<unsigned char>& raw) {
+    return raw.size() >= 6 && std::memcmp(raw.data(), SIG_MAGIC, 4) == 0;
+}
 
-void save_elgamal_keys(const ElGamalKey& key) {
-    std::ofstream priv("elgamal_priv.key");
-    priv << key.p << " " << key.g << " " << key.x << "\n";
-    priv.close();
-    
-    std::ofstream pub("elgamal_pub.key");
-    pub << key.p << " " << key.g << " " << key.y << "\n";
-    pub.close();
+bool elgamal_decode_signature(const std::vector<unsigned char>& raw, ElGamalSignature& sig) {
+    if (!elgamal_is_digest_signature(raw)) return false;
+    size_t len_r = raw[4], len_s = raw[5];
+    if (len_r > 128 || len_s > 128 || raw.size() != 6 + len_r + len_s) return false;
+    sig.r = ElgInt::from_bytes(std::vector<unsigned char>(raw.begin() + 6, raw.begin() + 6 + len_r));
+    sig.s = ElgInt::from_bytes(std::vector<unsigned char>(raw.begin() + 6 + len_r, raw.end()));
+    return true;
 }
 
-ElGamalKey load_elgamal_keys(bool pub_only = false) {
-    ElGamalKey k;
-    if (!pub_only) {
-        std::ifstream priv("elgamal_priv.key");
-        if (!priv) throw std::runtime_error("Cannot open private key file");
-        priv >> k.p >> k.g >> k.x;
-        k.y = mod_exp(k.g, k.x, k.p);
-        priv.close();
-    } else {
-        std::ifstream pub("elgamal_pub.key");
-        if (!pub) throw std::runtime_error("Cannot open public key file");
-        pub >> k.p >> k.g >> k.y;
-        pub.close();
+// ===== Старый формат: отдельная пара (r, s) по 16 байт на каждый байт хеша =====
+
+static u64 mod_exp(u64 base, u64 exp, u64 mod) {
+    u64 res = 1;
+    base %= mod;
+    while (exp > 0) {
+        if (exp & 1) res = (res * base) % mod;
+        base = (base * base) % mod;
+        exp >>= 1;
     }
-    return k;
+    return res;
 }
 
-struct ElGamalSignature {
+struct LegacyElGamalKey {
+    u64 p, g, y;
+};
+
+struct LegacyElGamalSignature {
     u64 r, s;
 };
 
-std::vector<ElGamalSignature> elgamal_sign_hash(const std::vector<unsigned char>& hash, const ElGamalKey& key) {
-    std::vector<ElGamalSignature> sigs;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<u64> dis(1, key.p - 2);
-
-    for (unsigned char byte : hash) {
-        u64 m = byte;
-        
-        // Генерируем k взаимно простое с p-1
-        u64 k;
-        do {
-            k = dis(gen);
-        } while (gcd(k, key.p - 1) != 1);
-        
-        u64 r = mod_exp(key.g, k, key.p);
-        u64 k_inv = mod_inv(k, key.p - 1);
-        
-        // Вычисляем s = k^(-1) * (m - x*r) mod (p-1)
-        i64 temp = static_cast<i64>(m) - static_cast<i64>(key.x) * static_cast<i64>(r);
-        temp = temp % static_cast<i64>(key.p - 1);
-        if (temp < 0) temp += key.p - 1;
-        
-        u64 s = (k_inv * static_cast<u64>(temp)) % (key.p - 1);
-        
-        sigs.push_back({r, s});
-    }
-    return sigs;
+// Если ключ уже заменён новым, старый лежит в elgamal_pub.key.legacy
+static bool load_legacy_pub_key(LegacyElGamalKey& k) {
+    std::string path = legacy_path(PUB_KEY_FILE);
+    if (!file_exists(path)) path = PUB_KEY_FILE;
+    std::ifstream pub(path);
+    if (!pub) throw std::runtime_error("Cannot open public key file");
+    pub >> k.p >> k.g >> k.y;
+    return static_cast<bool>(pub);
 }
 
-bool elgamal_verify_hash(const std::vector<unsigned char>& hash, const std::vector<ElGamalSignature>& sigs, const ElGamalKey& key) {
+static bool legacy_verify_hash(const std::vector<unsigned char>& hash, const std::vector<LegacyElGamalSignature>& sigs,
+                               const LegacyElGamalKey& key) {
     if (hash.size() != sigs.size()) {
         std::cout << "Hash and signature size mismatch: " << hash.size() << " vs " << sigs.size() << std::endl;
         return false;
     }
-    
+
     for (size_t i = 0; i < hash.size(); ++i) {
         u64 m = hash[i];
         u64 r = sigs[i].r;
         u64 s = sigs[i].s;
-        
+
         // Проверяем границы
         if (r == 0 || r >= key.p || s == 0 || s >= key.p - 1) {
             std::cout << "Invalid signature bounds at position " << i << std::endl;
             return false;
         }
-        
+
         // Проверяем: g^m ≡ y^r * r^s (mod p)
         u64 left = mod_exp(key.g, m, key.p);
-        u64 right1 = mod_exp(key.y, r, key.p);
-        u64 right2 = mod_exp(r, s, key.p);
-        u64 right = (right1 * right2) % key.p;
-        
+        u64 right = (mod_exp(key.y, r, key.p) * mod_exp(r, s, key.p)) % key.p;
+
         if (left != right) {
             std::cout << "Verification failed at byte " << i << std::endl;
-            std::cout << "Hash byte: " << m << std::endl;
-            std::cout << "Left: " << left << std::endl;
-            std::cout << "Right: " << right << std::endl;
-            std::cout << "Right1: " << right1 << std::endl;
-            std::cout << "Right2: " << right2 << std::endl;
-            std::cout << "r: " << r << ", s: " << s << std::endl;
             return false;
         }
     }
     return true;
 }
 
+static bool legacy_verify_file(const std::vector<unsigned char>& hash, const std::vector<unsigned char>& raw_sig) {
+    if (raw_sig.size() % 16 != 0) {
+        std::cout << "Invalid signature size: " << raw_sig.size() << " (not divisible by 16)" << std::endl;
+        return false;
+    }
+
+    std::vector<LegacyElGamalSignature> sigs;
+    for (size_t i = 0; i < raw_sig.size(); i += 16) {
+        u64 r = 0, s = 0;
+        for (int j = 0; j < 8; ++j) r |= (u64(raw_sig[i + j]) << (j * 8));
+        for (int j = 0; j < 8; ++j) s |= (u64(raw_sig[i + 8 + j]) << (j * 8));
+        sigs.push_back({r, s});
+    }
+    std::cout << "Loaded " << sigs.size() << " legacy per-byte signature pairs" << std::endl;
+
+    LegacyElGamalKey key;
+    if (!load_legacy_pub_key(key)) {
+        std::cout << "Public key file is not in the legacy format" << std::endl;
+        return false;
+    }
+    std::cout << "Legacy public key loaded: p=" << key.p << ", g=" << key.g << ", y=" << key.y << std::endl;
+    return legacy_verify_hash(hash, sigs, key);
+}
+
+// ===== Работа с файлами и потоками =====
+
+// Десятичный ключ старого формата: не двоичный ELGB и не текстовый ELG1
+static bool is_decimal_key_file(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4] = {};
+    in.read(magic, 4);
+    return std::memcmp(magic, "ELGB", 4) != 0 && std::memcmp(magic, "ELG1", 4) != 0;
+}
+
+static std::string rotated_path(const char* path, unsigned n) {
+    return std::string(path) + "." + std::to_string(n);
+}
+
+// Суффикс, под которым сохраняется прежняя пара ключей: .legacy — только для десятичной пары
+// и только если это имя свободно, иначе первый номер, свободный для обоих файлов.
+// Обе пары имён проверяются до создания ключа, так что пара переносится целиком.
+static std::string old_keys_suffix() {
+    bool decimal = true;
+    for (const char* path : {PRIV_KEY_FILE, PUB_KEY_FILE})
+        if (file_exists(path) && !is_decimal_key_file(path)) decimal = false;
+    if (decimal && !file_exists(legacy_path(PRIV_KEY_FILE)) && !file_exists(legacy_path(PUB_KEY_FILE)))
+        return LEGACY_SUFFIX;
+    unsigned n = 1;
+    while (file_exists(rotated_path(PRIV_KEY_FILE, n)) || file_exists(rotated_path(PUB_KEY_FILE, n))) ++n;
+    return "." + std::to_string(n);
+}
+
+// Переносит оба файла или ни одного: если второй rename не удался, первый откатывается
+static void move_aside_old_keys(const std::string& suffix) {
+    std::string priv_to = PRIV_KEY_FILE + suffix, pub_to = PUB_KEY_FILE + suffix;
+    bool has_priv = file_exists(PRIV_KEY_FILE), has_pub = file_exists(PUB_KEY_FILE);
+    if (has_priv && std::rename(PRIV_KEY_FILE, priv_to.c_str()) != 0)
+        throw std::runtime_error("Cannot rename " + std::string(PRIV_KEY_FILE));
+    if (has_pub && std::rename(PUB_KEY_FILE, pub_to.c_str()) != 0) {
+        if (has_priv) std::rename(priv_to.c_str(), PRIV_KEY_FILE);
+        throw std::runtime_error("Cannot rename " + std::string(PUB_KEY_FILE));
+    }
+    if (has_priv || has_pub) std::cout << "Previous keys moved to *" << suffix << std::endl;
+}
+
+std::shared_ptr<const ElGamalKey> elgamal_signing_key() {
+    auto key = load_elgamal_key_cached(PRIV_KEY_FILE);
+    if (key && key->has_private) {
+        std::cout << "Using ElGamal key from " << PRIV_KEY_FILE << std::endl;
+        return key;
+    }
+    std::string suffix = old_keys_suffix();
+    std::cout << "Generating ElGamal keys..." << std::endl;
+    auto fresh = std::make_shared<ElGamalKey>(generate_elgamal_key());
+    std::cout << "Keys generated: p=" << fresh->p.bit_length() << " bits, g=" << fresh->g.to_hex() << std::endl;
+    std::cout << "Saving keys..." << std::endl;
+    move_aside_old_keys(suffix);
+    save_elgamal_key_files(*fresh, PRIV_KEY_FILE, PUB_KEY_FILE);
+    return fresh;
+}
+
+static void sign_hash_to(const std::vector<unsigned char>& hash, const std::string& sig_path) {
+    auto key = elgamal_signing_key();
+    std::cout << "Signing hash..." << std::endl;
+    auto out = elgamal_encode_signature(elgamal_sign_digest(hash, *key));
+
+    write_file(sig_path, out);
+    std::cout << "ElGamal signature saved to " << sig_path << " (" << out.size() << " bytes)" << std::endl;
+}
+
+// Проверка в sign_tool: причина отказа (кроме простого несовпадения) печатается
+static bool verify_and_report(const std::vector<unsigned char>& hash, const ElGamalSignature& sig,
+                              const ElGamalKey& key) {
+    ElGamalVerifyStatus status = elgamal_check_digest(hash, sig, key);
+    if (status != ElGamalVerifyStatus::VALID && status != ElGamalVerifyStatus::INVALID)
+        std::cout << elgamal_verify_status_text(status) << std::endl;
+    return status == ElGamalVerifyStatus::VALID;
+}
+
+// Подпись нового формата или старая побайтовая
+static bool verify_hash_from(const std::vector<unsigned char>& hash, const std::string& sig_path) {
+    std::cout << "Loading signature..." << std::endl;
+    auto raw_sig = read_file(sig_path);
+    std::cout << "Signature file size: " << raw_sig.size() << " bytes" << std::endl;
+
+    if (!elgamal_is_digest_signature(raw_sig)) return legacy_verify_file(hash, raw_sig);
+
+    ElGamalSignature sig;
+    if (!elgamal_decode_signature(raw_sig, sig)) {
+        std::cout << "Malformed signature file" << std::endl;
+        return false;
+    }
+    std::cout << "Verifying signature..." << std::endl;
+    auto key = load_elgamal_key_cached(PUB_KEY_FILE);
+    if (key && verify_and_report(hash, sig, *key)) return true;
+
+    // Подпись могла быть сделана ключом, который с тех пор заменён: .legacy и .1, .2, ...
+    std::vector<std::string> previous = {legacy_path(PUB_KEY_FILE)};
+    for (unsigned n = 1; file_exists(rotated_path(PUB_KEY_FILE, n)); ++n)
+        previous.push_back(rotated_path(PUB_KEY_FILE, n));
+    for (const auto& path : previous) {
+        auto old_key = load_elgamal_key_cached(path);
+        if (!old_key) continue;
+        std::cout << "Trying previous public key " << path << "..." << std::endl;
+        if (verify_and_report(hash, sig, *old_key)) return true;
+    }
+    if (!key) std::cout << "Public key file is missing or in the legacy format" << std::endl;
+    return false;
+}
+
 void elgamal_sign_file(const std::string& filename) {
     std::cout << "Computing SHA256 hash..." << std::endl;
     auto hash = sha256_file(filename);
     std::cout << "Hash computed, length: " << hash.size() << " bytes" << std::endl;
-    
-    std::cout << "Generating ElGamal keys..." << std::endl;
-    u64 p = find_prime(1000000);
-    u64 g = find_primitive_root(p);
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<u64> dis(1, p - 2);
-    u64 x = dis(gen);
-    u64 y = mod_exp(g, x, p);
-    
-    ElGamalKey key{p, g, x, y};
-    std::cout << "Keys generated: p=" << p << ", g=" << g << ", y=" << y << std::endl;
 
-    std::cout << "Saving keys..." << std::endl;
-    save_elgamal_keys(key);
-    
-    std::cout << "Signing hash..." << std::endl;
-    auto sigs = elgamal_sign_hash(hash, key);
-    std::cout << "Generated " << sigs.size() << " signature pairs" << std::endl;
-
-    // Сохраняем подпись
-    std::vector<unsigned char> out;
-    for (auto& sig : sigs) {
-        for (int i = 0; i < 8; ++i) out.push_back((sig.r >> (i * 8)) & 0xFF);
-        for (int i = 0; i < 8; ++i) out.push_back((sig.s >> (i * 8)) & 0xFF);
-    }
-    
-    write_file(filename + "_sig", out);
-    std::cout << "ElGamal signature saved to " << filename + "_sig" << std::endl;
+    sign_hash_to(hash, filename + "_sig");
 }
 
 void elgamal_verify_file(const std::string& filename) {
     std::cout << "Computing SHA256 hash..." << std::endl;
     auto hash = sha256_file(filename);
     std::cout << "Hash computed, length: " << hash.size() << " bytes" << std::endl;
-    
-    std::cout << "Loading signature..." << std::endl;
-    auto raw_sig = read_file(filename + "_sig");
-    std::cout << "Signature file size: " << raw_sig.size() << " bytes" << std::endl;
 
-    if (raw_sig.size() % 16 != 0) {
-        std::cout << "Invalid signature size: " << raw_sig.size() << " (not divisible by 16)" << std::endl;
-        return;
-    }
+    bool ok = verify_hash_from(hash, filename + "_sig");
 
-    std::vector<ElGamalSignature> sigs;
-    for (size_t i = 0; i < raw_sig.size(); i += 16) {
-        u64 r = 0, s = 0;
-        for (int j = 0; j < 8; ++j) r |= (u64(raw_sig[i + j]) << (j * 8));
-        for (int j = 0; j < 8; ++j) s |= (u64(raw_sig[i + 8 + j]) << (j * 8));
-        sigs.push_back({r, s});
-    }
-    std::cout << "Loaded " << sigs.size() << " signature pairs" << std::endl;
+    std::ofstream out(filename + "_ver");
+    out << (ok ? "VALID" : "INVALID");
+    std::cout << "ElGamal verification: " << (ok ? "VALID" : "INVALID") << std::endl;
+}
 
-    std::cout << "Loading public key..." << std::endl;
-    auto key = load_elgamal_keys(true);
-    std::cout << "Public key loaded: p=" << key.p << ", g=" << key.g << ", y=" << key.y << std::endl;
-    
-    std::cout << "Verifying signature..." << std::endl;
-    bool ok = elgamal_verify_hash(hash, sigs, key);
+void elgamal_sign_file_chunked(const std::string& filename) {
+    std::cout << "Computing chunked SHA256 hash..." << std::endl;
+    ChunkDigestStats stats;
+    auto hash = chunked_sha256_file(filename, true, &stats);
+    std::cout << "Chunks: " << stats.chunks << ", rehashed: " << stats.rehashed << std::endl;
+
+    sign_hash_to(hash, filename + "_sig");
+}
+
+void elgamal_verify_file_chunked(const std::string& filename) {
+    std::cout << "Computing chunked SHA256 hash..." << std::endl;
+    auto hash = chunked_sha256_file(filename, false);
+
+    bool ok = verify_hash_from(hash, filename + "_sig");
 
     std::ofstream out(filename + "_ver");
     out << (ok ? "VALID" : "INVALID");
     std::cout << "ElGamal verification: " << (ok ? "VALID" : "INVALID") << std::endl;
-}
\ No newline at end of file
+}
+
+void elgamal_sign_stream(const std::string& sig_path) {
+    std::cout << "Hashing stdin..." << std::endl;
+    auto hash = sha256_stream(STDIN_FILENO, STDOUT_FILENO);
+    sign_hash_to(hash, sig_path);
+}
+
+bool elgamal_verify_stream(const std::string& sig_path) {
+    std::cout << "Hashing stdin..." << std::endl;
+    auto hash = sha256_stream(STDIN_FILENO, STDOUT_FILENO);
+    bool ok = verify_hash_from(hash, sig_path);
+    std::cout << "ElGamal verification: " << (ok ? "VALID" : "INVALID") << std::endl;
+    return ok;
+}
@@ -1,122 +1,52 @@
 #include "../include/fips186.h"
 #include "../include/utils.h" // sha256_file, read_file, write_file
-#include <random>
+#include "../include/parallel.h"
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
+#include <chrono>
 
 using namespace std;
 
-uint64_t FIPS186::to_uint64(const std::vector<unsigned char>& v) {
-    if (v.empty()) return 0;
-    uint64_t res = 0;
-    for (int i = (int)v.size() - 1; i >= 0; --i) {
-        res = (res << 8) | v[i];
-    }
-    return res;
-}
-
-std::vector<unsigned char> FIPS186::from_uint64(uint64_t n) {
-    std::vector<unsigned char> result;
-    if (n == 0) {
-        result.push_back(0);
-        return result;
-    }
-    while (n > 0) {
-        result.push_back(static_cast<unsigned char>(n & 0xFF));
-        n >>= 8;
-    }
-    return result;
-}
-
-uint64_t FIPS186::mod_mul(uint64_t a, uint64_t b, uint64_t mod) {
-    return (a * b) % mod;
-}
-
-uint64_t FIPS186::mod_exp(uint64_t base, uint64_t exp, uint64_t mod) {
-    if (mod == 1) return 0;
-    uint64_t result = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1) result = mod_mul(result, base, mod);
-        base = mod_mul(base, base, mod);
-        exp >>= 1;
-    }
-    return result;
-}
+// p — 64-битное простое, q — 48-битное простое, q | (p-1), g = 2^((p-1)/q) mod p.
+// Константы Монтгомери считаются при компиляции.
+static constexpr FIPS186::ModP FIPS_MOD_P(FIPS186::IntP::from_u64(0x89761798a431469fULL));
+static constexpr FIPS186::ModQ FIPS_MOD_Q(FIPS186::IntQ::from_u64(0x8cca89e79c87ULL));
+static constexpr uint64_t FIPS_G = 0x73573f0366830378ULL;
 
-uint64_t FIPS186::mod_inv(uint64_t a, uint64_t mod) {
-    a %= mod;
-    if (a == 0) throw std::runtime_error("mod_inv: division by zero");
-    int64_t t0 = 0, t1 = 1;
-    int64_t r0 = mod, r1 = a;
-    while (r1 != 0) {
-        int64_t q = r0 / r1;
-        int64_t tmp = r1;
-        r1 = r0 - q * r1;
-        r0 = tmp;
-
-        tmp = t1;
-        t1 = t0 - q * t1;
-        t0 = tmp;
-    }
-    if (r0 != 1) throw std::runtime_error("mod_inv: no inverse");
-    if (t0 < 0) t0 += mod;
-    return static_cast<uint64_t>(t0);
-}
+FIPS186::FIPS186() : mod_p(FIPS_MOD_P), mod_q(FIPS_MOD_Q), g(IntP::from_u64(FIPS_G)) {}
 
-bool FIPS186::is_zero(const vector<unsigned char>& n) {
-    for (auto b : n) if (b != 0) return false;
-    return true;
+// h = hash(message) mod q (если h=0, то h=1); хеш используется целиком
+FIPS186::IntQ FIPS186::hash_to_q(const vector<unsigned char>& message_hash) const {
+    IntQ h = mod_q.reduce(BigUInt<4>::from_bytes(message_hash));
+    if (h.is_zero()) h = IntQ::from_u64(1);
+    return h;
 }
 
-bool FIPS186::less(const vector<unsigned char>& a, const vector<unsigned char>& b) {
-    if (a.size() != b.size()) return a.size() < b.size();
-    for (int i = (int)a.size() - 1; i >= 0; --i) {
-        if (a[i] != b[i]) return a[i] < b[i];
-    }
-    return false;
+// Генерация ключей: секретный x (0 < x < q), публичный y = g^x mod p
+void FIPS186::generate_keys() {
+    x = mod_q.random();
+    y = mod_p.pow_ct(g, x);
 }
 
-vector<unsigned char> FIPS186::random_number(const vector<unsigned char>& max) {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<unsigned char> dis(0, 255);
-    vector<unsigned char> result(max.size());
+// Всё, что не зависит от сообщения и ключа: k, r = (g^k mod p) mod q != 0, k^{-1} mod q
+FIPS186::Presig FIPS186::make_presig() {
+    Presig pre;
     do {
-        for (size_t i = 0; i < max.size(); ++i) result[i] = dis(gen);
-    } while (!less(result, max) || is_zero(result));
-    return result;
+        pre.k = mod_q.random();
+        pre.r = mod_q.reduce(mod_p.pow_ct(g, pre.k));
+    } while (pre.r.is_zero());
+    pre.k_inv = mod_q.inverse_ct(pre.k);
+    return pre;
 }
 
-// p=bq+1
-//g=^q modp=1
-//q=160 бит
-FIPS186::FIPS186() {
-    // Небольшие тестовые простые p и q, 
-    p = from_uint64(1279); // простые
-    q = from_uint64(71);   
-    // вычислим g - берем h=2 и поднимаем в степень (p-1)/q
-    uint64_t p_v = to_uint64(p), q_v = to_uint64(q);
-    uint64_t h = 2;
-    uint64_t exponent = (p_v - 1) / q_v;
-    uint64_t g_v = mod_exp(h, exponent, p_v);
-    if (g_v <= 1) g_v = 34; 
-    g = from_uint64(g_v);
-    x = from_uint64(0);
-    y = from_uint64(0);
+void FIPS186::start_precompute(size_t capacity) {
+    presign.reset();
+    presign.reset(new PresignPool<Presig>(capacity, [this]() { return make_presig(); }));
 }
 
-// Генерация ключей: секретный x (0 < x < q), публичный y = g^x mod p
-void FIPS186::generate_keys() {
-    x = random_number(q);
-    uint64_t x_v = to_uint64(x);
-    uint64_t p_v = to_uint64(p);
-    uint64_t g_v = to_uint64(g);
-    uint64_t y_v = mod_exp(g_v, x_v, p_v);
-
-    // записываем публичный ключ
-    y = from_uint64(y_v);
+void FIPS186::stop_precompute() {
+    presign.reset();
 }
 
 // r = (g^k mod p) mod q
@@ -127,27 +57,17 @@ void FIPS186::generate_keys() {
 //s кодирует информацию о секретном ключе x в подписи.
 pair<vector<unsigned char>, vector<unsigned char>> 
 FIPS186::sign(const vector<unsigned char>& message_hash) {
-    uint64_t q_v = to_uint64(q);
-    uint64_t p_v = to_uint64(p);
-    uint64_t g_v = to_uint64(g);
-    uint64_t x_v = to_uint64(x);
-
-    uint64_t h = to_uint64(message_hash) % q_v;
-    if (h == 0) h = 1;
+    IntQ h = hash_to_q(message_hash);
 
-    uint64_t r = 0, s = 0;
+    IntQ r, s;
     do {
-        uint64_t k = to_uint64(random_number(q));
-        if (k == 0) continue;
-        uint64_t k_mod = k % q_v;
-        uint64_t tmp = mod_exp(g_v, k, p_v) % q_v;
-        r = tmp;
-        if (r == 0) continue;
-        uint64_t k_inv = mod_inv(k_mod, q_v);
-        s = (k_inv * ((h + (x_v * r) % q_v) % q_v)) % q_v;
-    } while (r == 0 || s == 0);
-
-    return make_pair(from_uint64(r), from_uint64(s));
+        Presig pre;
+        if (!presign || !presign->try_pop(pre)) pre = make_presig();
+        r = pre.r;
+        s = mod_q.mul_mod(pre.k_inv, mod_q.add(h, mod_q.mul_mod(x, r)));
+    } while (s.is_zero());
+
+    return make_pair(r.to_bytes(), s.to_bytes());
 }
 
 // 0 < r < q, 0 < s < q
@@ -156,31 +76,53 @@ FIPS186::sign(const vector<unsigned char>& message_hash) {
 // u2 = (r * w) mod q
 // v = ((g^u1 * y^u2) mod p) mod q
 // проверяем v == r
+bool FIPS186::verify_exponents(const vector<unsigned char>& message_hash, const SignaturePair& signature,
+                               IntQ& r, IntQ& u1, IntQ& u2) const {
+    if (signature.first.size() > ModQ::LIMBS * 8 || signature.second.size() > ModQ::LIMBS * 8) return false;
+    r = IntQ::from_bytes(signature.first);
+    IntQ s = IntQ::from_bytes(signature.second);
+    if (r.is_zero() || !(r < mod_q.modulus()) || s.is_zero() || !(s < mod_q.modulus())) return false;
+
+    IntQ h = hash_to_q(message_hash);
+
+    IntQ s_inv = mod_q.inverse(s);
+    u1 = mod_q.mul_mod(h, s_inv);
+    u2 = mod_q.mul_mod(r, s_inv);
+    return true;
+}
+
 bool FIPS186::verify(const vector<unsigned char>& message_hash,
                      const pair<vector<unsigned char>, vector<unsigned char>>& signature) {
-    uint64_t r = to_uint64(signature.first);
-    uint64_t s = to_uint64(signature.second);
-    uint64_t q_v = to_uint64(q);
-    if (r == 0 || r >= q_v || s == 0 || s >= q_v) return false;
-
-    uint64_t h = to_uint64(message_hash) % q_v;
-    if (h == 0) h = 1;
-
-    uint64_t s_inv = mod_inv(s, q_v);
-    uint64_t u1 = (h * s_inv) % q_v;
-    uint64_t u2 = (r * s_inv) % q_v;
-
-    uint64_t g_v = to_uint64(g);
-    uint64_t y_v = to_uint64(y);
-    uint64_t p_v = to_uint64(p);
+    IntQ r, u1, u2;
+    if (!verify_exponents(message_hash, signature, r, u1, u2)) return false;
 
-    uint64_t v1 = mod_exp(g_v, u1, p_v);
-    uint64_t v2 = mod_exp(y_v, u2, p_v);
-    uint64_t v = ( (v1 * v2) % p_v ) % q_v;
+    // g^u1 * y^u2 — одним совместным возведением в степень
+    IntQ v = mod_q.reduce(mod_p.pow2(g, u1, y, u2));
 
     return v == r;
 }
 
+// Те же шаги, что и в verify, но степени g и y берутся из таблиц,
+// построенных один раз на весь пакет
+BatchResult FIPS186::verify_batch(const vector<BatchItem>& items, unsigned threads) const {
+    auto start = chrono::steady_clock::now();
+    FixedBaseTable<ModP::LIMBS, ModQ::LIMBS> table_g(mod_p, g), table_y(mod_p, y);
+
+    BatchResult result;
+    result.valid.assign(items.size(), 0);
+    parallel_for(items.size(), threads, [&](size_t i) {
+        IntQ r, u1, u2;
+        if (!verify_exponents(items[i].hash, items[i].signature, r, u1, u2)) return;
+        IntP v = mod_p.from_mont(mod_p.mul(table_g.pow_mont(u1), table_y.pow_mont(u2)));
+        result.valid[i] = (mod_q.reduce(v) == r);
+    });
+
+    for (auto ok : result.valid) result.valid_count += ok;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.per_second = result.seconds > 0 ? items.size() / result.seconds : 0;
+    return result;
+}
+
 void FIPS186::save_signature(const pair<vector<unsigned char>, vector<unsigned char>>& signature,
                              const string& filename) {
     ofstream file(filename, ios::binary);
@@ -231,3 +173,26 @@ void fips_sign_and_verify_file(const std::string& filename) {
     if (ok) std::cout << "FIPS signature verification: OK\n";
     else std::cout << "FIPS signature verification: FAILED\n";
 }
+
+void fips_sign_and_verify_files(const std::vector<std::string>& filenames) {
+    FIPS186 fips;
+    fips.generate_keys();
+    fips.start_precompute(); // (k, r) считаются в фоне, пока хешируются файлы
+
+    std::vector<BatchItem> items;
+    for (const auto& filename : filenames) {
+        auto hash = sha256_file(filename);
+        std::string sigfile = filename + ".fips.sig";
+        fips.save_signature(fips.sign(hash), sigfile);
+        std::cout << "FIPS signature saved to: " << sigfile << std::endl;
+        items.push_back({hash, fips.load_signature(sigfile)});
+    }
+
+    auto result = fips.verify_batch(items);
+    for (size_t i = 0; i < filenames.size(); ++i) {
+        std::cout << "FIPS signature verification (" << filenames[i] << "): "
+                  << (result.valid[i] ? "OK" : "FAILED") << "\n";
+    }
+    std::cout << "Batch: " << result.valid_count << "/" << items.size() << " valid, "
+              << result.seconds * 1000 << " ms, " << result.per_second << " verifications/s\n";
+}
@@ -22,4 +22,29 @@ void gost_sign_and_verify_file(const string& filename) {
     } else {
         throw runtime_error("Verification failed");
     }
-}
\ No newline at end of file
+}
+
+void gost_sign_and_verify_files(const vector<string>& filenames) {
+    GOST341094 gost;
+    gost.generate_keys();
+    gost.start_precompute(); // (k, r) считаются в фоне, пока хешируются файлы
+
+    vector<BatchItem> items;
+    for (const auto& filename : filenames) {
+        auto hash = sha256_file(filename);
+        string sigFile = filename + ".gost_sig";
+        gost.save_signature(gost.sign(hash), sigFile);
+        cout << "✓ Signed → " << sigFile << endl;
+        items.push_back({hash, gost.load_signature(sigFile)});
+    }
+
+    auto result = gost.verify_batch(items);
+    for (size_t i = 0; i < filenames.size(); ++i) {
+        cout << (result.valid[i] ? "✓ Verified OK: " : "✗ Verification failed: ") << filenames[i] << endl;
+    }
+    cout << "Batch: " << result.valid_count << "/" << items.size() << " valid, "
+         << result.seconds * 1000 << " ms, " << result.per_second << " verifications/s" << endl;
+    if (result.valid_count != items.size()) {
+        throw runtime_error("Verification failed");
+    }
+}
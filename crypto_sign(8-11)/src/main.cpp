@@ -4,35 +4,67 @@
 #include "../include/fips186.h"   
 #include <iostream>
 #include <string>
+#include <vector>
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <rsa|elgamal|gost|fips> <filename>\n";
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <rsa|elgamal|elgamal-verify|elgamal-chunked|elgamal-verify-chunked|gost|fips> <filename> [filename...]\n";
+        std::cerr << "       " << argv[0] << " <elgamal-stream|elgamal-verify-stream> <sigfile>   # stdin -> stdout\n";
         std::cerr << "Examples:\n";
         std::cerr << "  " << argv[0] << " rsa document.txt\n";
         std::cerr << "  " << argv[0] << " elgamal data.bin\n";
+        std::cerr << "  " << argv[0] << " elgamal-verify data.bin   # проверка существующей data.bin_sig\n";
+        std::cerr << "  " << argv[0] << " elgamal-chunked disk.img   # повторно — только по изменённым файлам\n";
         std::cerr << "  " << argv[0] << " gost file.pdf\n";
         std::cerr << "  " << argv[0] << " fips file.pdf\n";
+        std::cerr << "  " << argv[0] << " gost a.bin b.bin c.bin   # один ключ, пакетная проверка\n";
+        std::cerr << "  tar c dir | " << argv[0] << " elgamal-stream dir.tar.sig > dir.tar\n";
         return 1;
     }
 
     std::string algo = argv[1];
-    std::string file = argv[2];
+    std::vector<std::string> files(argv + 2, argv + argc);
 
     try {
-        if (algo == "rsa") {
-            rsa_sign_file(file);
-            rsa_verify_file(file);
+        if (algo == "elgamal-stream" || algo == "elgamal-verify-stream") {
+            // stdout занят данными, поэтому журнал уходит в stderr
+            std::cout.rdbuf(std::cerr.rdbuf());
+            if (algo == "elgamal-stream") {
+                elgamal_sign_stream(files[0]);
+                return 0;
+            }
+            return elgamal_verify_stream(files[0]) ? 0 : 2;
+        }
+        else if (algo == "rsa") {
+            for (const auto& file : files) {
+                rsa_sign_file(file);
+                rsa_verify_file(file);
+            }
         } 
         else if (algo == "elgamal") {
-            elgamal_sign_file(file);
-            elgamal_verify_file(file);
+            for (const auto& file : files) {
+                elgamal_sign_file(file);
+                elgamal_verify_file(file);
+            }
+        }
+        else if (algo == "elgamal-verify") {
+            // только проверка: подпись нового формата или старая побайтовая
+            for (const auto& file : files) elgamal_verify_file(file);
+        }
+        else if (algo == "elgamal-chunked") {
+            // хеш по блокам с кешем <file>.chunks: неизменённый файл не перечитывается
+            for (const auto& file : files) elgamal_sign_file_chunked(file);
+        }
+        else if (algo == "elgamal-verify-chunked") {
+            for (const auto& file : files) elgamal_verify_file_chunked(file);
         }
         else if (algo == "gost") {
-            gost_sign_and_verify_file(file);
+            if (files.size() == 1) gost_sign_and_verify_file(files[0]);
+            else gost_sign_and_verify_files(files);
         }
         else if (algo == "fips") {
-            fips_sign_and_verify_file(file); 
+            if (files.size() == 1) fips_sign_and_verify_file(files[0]);
+            else fips_sign_and_verify_files(files);
         }
         else {
             std::cerr << "Unknown algorithm. Use 'rsa', 'elgamal', 'gost' or 'fips'\n";
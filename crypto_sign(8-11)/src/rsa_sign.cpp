@@ -32,6 +32,28 @@ RSA* load_public_key() {
     return rsa;
 }
 
+bool rsa_sign_hash(const std::vector<unsigned char>& hash, RSA* rsa, std::vector<unsigned char>& signature) {
+    signature.clear();
+    for (unsigned char b : hash) {
+        unsigned char sig[256];
+        unsigned int siglen;
+        if (!RSA_sign(NID_sha256, &b, 1, sig, &siglen, rsa)) return false;
+        signature.insert(signature.end(), sig, sig + siglen);
+    }
+    return true;
+}
+
+bool rsa_verify_hash(const std::vector<unsigned char>& hash, const std::vector<unsigned char>& signature, RSA* rsa) {
+    size_t pos = 0;
+    for (unsigned char b : hash) {
+        unsigned int siglen = RSA_size(rsa);
+        if (pos + siglen > signature.size()) return false;
+        if (RSA_verify(NID_sha256, &b, 1, signature.data() + pos, siglen, rsa) != 1) return false;
+        pos += siglen;
+    }
+    return true;
+}
+
 void rsa_sign_file(const std::string& filename) {
     auto hash = sha256_file(filename);
 
@@ -44,15 +66,10 @@ void rsa_sign_file(const std::string& filename) {
     save_rsa_keys(rsa);
 
     std::vector<unsigned char> signature;
-    for (unsigned char b : hash) {
-        unsigned char sig[256];
-        unsigned int siglen;
-        if (!RSA_sign(NID_sha256, &b, 1, sig, &siglen, rsa)) {
-            std::cerr << "Signing byte failed\n";
-            RSA_free(rsa);
-            return;
-        }
-        signature.insert(signature.end(), sig, sig + siglen);
+    if (!rsa_sign_hash(hash, rsa, signature)) {
+        std::cerr << "Signing byte failed\n";
+        RSA_free(rsa);
+        return;
     }
     RSA_free(rsa);
 
@@ -70,18 +87,7 @@ void rsa_verify_file(const std::string& filename) {
         return;
     }
 
-    size_t pos = 0;
-    bool ok = true;
-    for (unsigned char b : hash) {
-        unsigned int siglen = RSA_size(rsa);
-        if (pos + siglen > sig_data.size()) {
-            ok = false; break;
-        }
-        if (RSA_verify(NID_sha256, &b, 1, sig_data.data() + pos, siglen, rsa) != 1) {
-            ok = false; break;
-        }
-        pos += siglen;
-    }
+    bool ok = rsa_verify_hash(hash, sig_data, rsa);
     RSA_free(rsa);
 
     std::ofstream out(filename + "_ver");
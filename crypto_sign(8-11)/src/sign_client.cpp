@@ -0,0 +1,77 @@
+// Клиент демона подписи: запросы отправляются окнами не больше MAX_IN_FLIGHT, ответы читаются
+// по порядку, и на место каждого прочитанного ответа отправляется следующий запрос.
+// Подписи сохраняются рядом с файлами (<file>_sig), как у sign_tool.
+#include "../include/daemon_protocol.h"
+#include "../include/utils.h"
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static string absolute_path(const string& path) {
+    char buf[PATH_MAX];
+    if (!realpath(path.c_str(), buf)) throw runtime_error("Cannot resolve path: " + path);
+    return buf;
+}
+
+int main(int argc, char* argv[]) {
+    string socket_path = DEFAULT_SOCKET_PATH;
+    int i = 1;
+    if (i + 1 < argc && string(argv[i]) == "-s") {
+        socket_path = argv[i + 1];
+        i += 2;
+    }
+    if (i >= argc || (string(argv[i]) != "ping" && i + 1 >= argc)) {
+        cerr << "Usage: " << argv[0] << " [-s socket_path] <sign|verify> <file> [file...]\n";
+        cerr << "       " << argv[0] << " [-s socket_path] ping\n";
+        return 1;
+    }
+    string cmd = argv[i];
+    vector<string> files(argv + i + 1, argv + argc);
+
+    try {
+        if (cmd != "ping" && cmd != "sign" && cmd != "verify") throw runtime_error("Unknown command: " + cmd);
+        auto request = [&](size_t k) -> string {
+            if (cmd == "ping") return "PING\n";
+            if (cmd == "sign") return "SIGN FILE " + absolute_path(files[k]) + "\n";
+            return "VERIFY FILE " + absolute_path(files[k]) + " " + bytes_to_hex(read_file(files[k] + "_sig")) + "\n";
+        };
+
+        int fd = connect_unix(socket_path);
+        LineReader reader(fd);
+        string line;
+        int failed = 0;
+        size_t count = cmd == "ping" ? 1 : files.size();
+        size_t sent = 0;
+        for (size_t k = 0; k < count; ++k) {
+            // Демон перестаёт читать после MAX_IN_FLIGHT запросов без ответа
+            string batch;
+            while (sent < count && sent - k < MAX_IN_FLIGHT) batch += request(sent++);
+            if (!batch.empty()) send_all(fd, batch);
+            if (sent == count && !batch.empty()) shutdown(fd, SHUT_WR);
+
+            if (!reader.next(line)) throw runtime_error("Daemon closed the connection");
+            const string name = cmd == "ping" ? "ping" : files[k];
+            if (line.compare(0, 3, "OK ") != 0) {
+                cout << name << ": " << line << endl;
+                ++failed;
+            } else if (cmd == "sign") {
+                vector<unsigned char> sig;
+                hex_to_bytes(line.substr(3), sig);
+                write_file(name + "_sig", sig);
+                cout << name << ": signature saved to " << name + "_sig" << endl;
+            } else {
+                cout << name << ": " << line.substr(3) << endl;
+                if (line != "OK VALID" && line != "OK PONG") ++failed;
+            }
+        }
+        close(fd);
+        return failed ? 2 : 0;
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,176 @@
+// Демон подписи Эль-Гамаля: ключ загружается один раз и остаётся в памяти вместе с таблицами,
+// запросы принимаются через Unix-сокет (протокол — в daemon_protocol.h).
+// На каждое соединение — поток чтения и поток записи ответов; сама подпись и проверка
+// выполняются в общем пуле потоков, поэтому запросы одного соединения идут параллельно,
+// а ответы отправляются в порядке запросов.
+#include "../include/daemon_protocol.h"
+#include "../include/elgamal_sign.h"
+#include "../include/thread_pool.h"
+#include "../include/utils.h"
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+
+using namespace std;
+
+static string socket_path = DEFAULT_SOCKET_PATH;
+
+static void on_signal(int) {
+    unlink(socket_path.c_str());
+    _exit(0);
+}
+
+static string sign_response(const vector<unsigned char>& hash, const ElGamalKey& key) {
+    return "OK " + bytes_to_hex(elgamal_encode_signature(elgamal_sign_digest(hash, key)));
+}
+
+static string verify_response(const vector<unsigned char>& hash, const string& sig_hex, const ElGamalKey& key) {
+    vector<unsigned char> raw;
+    ElGamalSignature sig;
+    if (!hex_to_bytes(sig_hex, raw) || !elgamal_decode_signature(raw, sig)) return "ERR malformed signature";
+    return elgamal_verify_digest(hash, sig, key) ? "OK VALID" : "OK INVALID";
+}
+
+// Разбор и выполнение одного запроса; исключения превращаются в ERR
+static string handle_request(const string& line, const ElGamalKey& key) {
+    try {
+        istringstream in(line);
+        string cmd, kind;
+        in >> cmd >> kind;
+        if (cmd == "PING") return "OK PONG";
+        if (cmd != "SIGN" && cmd != "VERIFY") return "ERR unknown command";
+
+        string rest;
+        getline(in >> ws, rest);
+        string sig_hex;
+        if (cmd == "VERIFY") {
+            // подпись — последнее слово, всё до неё — путь или хеш
+            size_t space = rest.find_last_of(' ');
+            if (space == string::npos) return "ERR missing signature";
+            sig_hex = rest.substr(space + 1);
+            rest.erase(space);
+        }
+        if (rest.empty()) return "ERR missing argument";
+
+        vector<unsigned char> hash;
+        if (kind == "FILE") {
+            hash = sha256_file(rest);
+        } else if (kind == "DIGEST") {
+            if (!hex_to_bytes(rest, hash) || hash.empty()) return "ERR malformed digest";
+        } else {
+            return "ERR expected FILE or DIGEST";
+        }
+        return cmd == "SIGN" ? sign_response(hash, key) : verify_response(hash, sig_hex, key);
+    } catch (const exception& e) {
+        return string("ERR ") + e.what();
+    }
+}
+
+static void serve_connection(int fd, ThreadPool& pool, shared_ptr<const ElGamalKey> key) {
+    deque<future<string>> pending;
+    mutex m;
+    condition_variable cv;
+    bool reading_done = false;
+
+    // Ответы забираются строго по порядку: future первого запроса, потом второго и т.д.
+    thread writer([&] {
+        bool broken = false;
+        for (;;) {
+            future<string> next;
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [&] { return !pending.empty() || reading_done; });
+                if (pending.empty()) break;
+                next = move(pending.front());
+                pending.pop_front();
+            }
+            cv.notify_all();
+            string response = next.get();
+            if (broken) continue;
+            try {
+                send_all(fd, response + "\n");
+            } catch (const exception&) {
+                broken = true; // клиент ушёл; оставшиеся задачи просто дорабатываются
+                shutdown(fd, SHUT_RD);
+            }
+        }
+    });
+
+    try {
+        LineReader reader(fd);
+        string line;
+        while (reader.next(line)) {
+            if (line.empty()) continue;
+            unique_lock<mutex> lock(m);
+            cv.wait(lock, [&] { return pending.size() < MAX_IN_FLIGHT; });
+            pending.push_back(pool.submit([line, key] { return handle_request(line, *key); }));
+            cv.notify_all();
+        }
+    } catch (const exception& e) {
+        cerr << "Connection error: " << e.what() << endl;
+    }
+
+    {
+        lock_guard<mutex> lock(m);
+        reading_done = true;
+    }
+    cv.notify_all();
+    writer.join();
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "-t" && i + 1 < argc) {
+            threads = static_cast<unsigned>(stoul(argv[++i]));
+        } else {
+            cerr << "Usage: " << argv[0] << " [-s socket_path] [-t threads]\n";
+            cerr << "  default socket: " << DEFAULT_SOCKET_PATH << ", threads: number of cores\n";
+            return 1;
+        }
+    }
+
+    try {
+        auto key = elgamal_signing_key();
+        ThreadPool pool(threads);
+
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) throw runtime_error(string("socket: ") + strerror(errno));
+        sockaddr_un addr = unix_address(socket_path);
+        unlink(socket_path.c_str());
+        mode_t old_mask = umask(0077); // сокет 0600: подписывать может только владелец
+        int rc = ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        umask(old_mask);
+        if (rc < 0) throw runtime_error("Cannot bind " + socket_path + ": " + strerror(errno));
+        if (listen(listen_fd, 64) < 0) throw runtime_error(string("listen: ") + strerror(errno));
+
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+        cout << "Signing daemon listening on " << socket_path << " (" << pool.size() << " worker threads)" << endl;
+
+        for (;;) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error(string("accept: ") + strerror(errno));
+            }
+            thread(serve_connection, fd, ref(pool), key).detach();
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        unlink(socket_path.c_str());
+        return 1;
+    }
+}
@@ -0,0 +1,129 @@
+// Нагрузочный генератор для sign_daemon: несколько соединений, в каждом до depth
+// запросов в полёте. Выводит число запросов в секунду и задержки p50/p99.
+#include "../include/daemon_protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct LoadOptions {
+    string socket_path = DEFAULT_SOCKET_PATH;
+    string op = "sign";      // sign или verify
+    unsigned connections = 4;
+    size_t requests = 1000;  // на одно соединение
+    size_t depth = 16;       // запросов в полёте на соединение
+};
+
+static string random_digest_hex(mt19937_64& rng) {
+    vector<unsigned char> digest(32);
+    for (auto& b : digest) b = static_cast<unsigned char>(rng());
+    return bytes_to_hex(digest);
+}
+
+// Одно соединение; задержки дописываются в latencies (мкс)
+static void run_connection(const LoadOptions& opt, unsigned id, vector<double>& latencies, size_t& errors) {
+    int fd = connect_unix(opt.socket_path);
+    LineReader reader(fd);
+    mt19937_64 rng(id);
+    string line;
+
+    // Для проверки нужна готовая подпись: одна на соединение
+    string digest = random_digest_hex(rng);
+    string request = "SIGN DIGEST " + digest + "\n";
+    if (opt.op == "verify") {
+        send_all(fd, request);
+        if (!reader.next(line) || line.compare(0, 3, "OK ") != 0) throw runtime_error("Cannot get signature");
+        request = "VERIFY DIGEST " + digest + " " + line.substr(3) + "\n";
+    }
+
+    queue<Clock::time_point> sent_at; // ответы приходят по порядку запросов
+    size_t sent = 0, received = 0;
+    latencies.reserve(opt.requests);
+    while (received < opt.requests) {
+        string batch;
+        while (sent < opt.requests && sent - received < opt.depth) {
+            batch += request;
+            sent_at.push(Clock::now());
+            ++sent;
+        }
+        if (!batch.empty()) send_all(fd, batch);
+
+        if (!reader.next(line)) throw runtime_error("Daemon closed the connection");
+        latencies.push_back(chrono::duration<double, micro>(Clock::now() - sent_at.front()).count());
+        sent_at.pop();
+        ++received;
+        if (line.compare(0, 3, "OK ") != 0 || line == "OK INVALID") ++errors;
+    }
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Usage: " << argv[0] << " [-s socket] [-o sign|verify] [-c connections] [-n requests] [-d depth]\n";
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "-s") opt.socket_path = value;
+        else if (arg == "-o") opt.op = value;
+        else if (arg == "-c") opt.connections = static_cast<unsigned>(stoul(value));
+        else if (arg == "-n") opt.requests = stoull(value);
+        else if (arg == "-d") opt.depth = max<size_t>(1, stoull(value));
+        else {
+            cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (opt.op != "sign" && opt.op != "verify") {
+        cerr << "Operation must be sign or verify\n";
+        return 1;
+    }
+
+    vector<vector<double>> latencies(opt.connections);
+    vector<size_t> errors(opt.connections, 0);
+    vector<string> failures;
+    mutex failures_mutex;
+
+    auto start = Clock::now();
+    vector<thread> clients;
+    for (unsigned c = 0; c < opt.connections; ++c) {
+        clients.emplace_back([&, c] {
+            try {
+                run_connection(opt, c, latencies[c], errors[c]);
+            } catch (const exception& e) {
+                lock_guard<mutex> lock(failures_mutex);
+                failures.push_back(e.what());
+            }
+        });
+    }
+    for (auto& t : clients) t.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    for (const auto& f : failures) cerr << "Error: " << f << "\n";
+    vector<double> all;
+    size_t total_errors = 0;
+    for (unsigned c = 0; c < opt.connections; ++c) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        total_errors += errors[c];
+    }
+    if (all.empty()) return 1;
+    sort(all.begin(), all.end());
+    auto pct = [&](double p) { return all[static_cast<size_t>(ceil(p * all.size())) - 1]; };
+
+    cout << opt.op << ": " << all.size() << " requests over " << opt.connections << " connections, depth "
+         << opt.depth << "\n";
+    cout << "  " << all.size() / seconds << " req/s, p50 " << pct(0.50) << " us, p99 " << pct(0.99) << " us, errors "
+         << total_errors << endl;
+    return failures.empty() && total_errors == 0 ? 0 : 2;
+}
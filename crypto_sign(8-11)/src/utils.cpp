@@ -2,6 +2,9 @@
 #include <openssl/sha.h>
 #include <fstream>
 #include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
 
 std::vector<unsigned char> sha256_file(const std::string& filename) {
     std::ifstream file(filename, std::ios::binary);
@@ -26,6 +29,40 @@ std::vector<unsigned char> sha256_file(const std::string& filename) {
     return hash;
 }
 
+static void write_all(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Cannot write stream: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= n;
+    }
+}
+
+std::vector<unsigned char> sha256_stream(int in_fd, int tee_fd) {
+    SHA256_CTX sha256;
+    SHA256_Init(&sha256);
+
+    const size_t buffer_size = 65536;
+    std::vector<unsigned char> buffer(buffer_size);
+    for (;;) {
+        ssize_t bytes = ::read(in_fd, buffer.data(), buffer_size);
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Cannot read stream: ") + std::strerror(errno));
+        }
+        if (bytes == 0) break;
+        SHA256_Update(&sha256, buffer.data(), bytes);
+        if (tee_fd >= 0) write_all(tee_fd, buffer.data(), bytes);
+    }
+
+    std::vector<unsigned char> hash(SHA256_DIGEST_LENGTH);
+    SHA256_Final(hash.data(), &sha256);
+    return hash;
+}
+
 void write_file(const std::string& filename, const std::vector<unsigned char>& data) {
     std::ofstream file(filename, std::ios::binary);
     file.write(reinterpret_cast<const char*>(data.data()), data.size());
@@ -0,0 +1,31 @@
+#include "round_trace.hpp"
+#include <cstdlib>
+#include <new>
+
+// Подсчёт выделений памяти для сводки раундов (threadAllocs). Отдельным объектом, чтобы
+// замена operator new попадала только в программы с замерами, а не, например, в verify.
+static thread_local AllocStats allocs{0, 0};
+
+AllocStats threadAllocs(){ return allocs; }
+
+// Глобальные operator new/delete: выделение через malloc с учётом в счётчике потока.
+// Выровненные варианты не заменяются — в коде раундов они не используются.
+static void* countedAlloc(size_t size){
+    allocs.count++;
+    allocs.bytes += size;
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size){ return countedAlloc(size); }
+void* operator new[](size_t size){ return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch(...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch(...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
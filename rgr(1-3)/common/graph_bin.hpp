@@ -0,0 +1,155 @@
+#pragma once
+// Двоичный формат графа, общий для rgr-1 и rgr-2. Файл отображается в память (mmap),
+// массив рёбер используется прямо из отображения — разбора текста нет.
+//
+// Раскладка (числа little-endian):
+//   0   заголовок GraphBinHeader (64 байта)
+//   64  рёбра: m пар (u, v) по uint32, нумерация с 0
+//   ... необязательная секция: раскраска (n × uint8, цвета 1..3) или цикл (n × uint32, с 0)
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct GraphEdge {
+    uint32_t u, v;
+};
+
+struct GraphBinHeader {
+    static constexpr uint32_t HAS_COLORS = 1, HAS_CYCLE = 2;
+
+    char magic[4];
+    uint32_t flags;
+    uint64_t n, m;
+    uint64_t edgesOffset, extraOffset; // extraOffset = 0 — секции нет
+    uint8_t reserved[24];
+};
+static_assert(sizeof(GraphBinHeader) == 64, "GraphBinHeader must be 64 bytes");
+
+inline const char* graphBinMagic(){ return "GRB1"; }
+
+// true, если файл начинается с сигнатуры двоичного формата
+inline bool isGraphBin(const std::string& path){
+    char magic[4];
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f) return false;
+    bool ok = std::fread(magic, 1, 4, f) == 4 && std::memcmp(magic, graphBinMagic(), 4) == 0;
+    std::fclose(f);
+    return ok;
+}
+
+// Граф, отображённый в память только для чтения; размеры секций проверяются при открытии
+class MappedGraph {
+public:
+    explicit MappedGraph(const std::string& path){
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("Cannot open " + path);
+        struct stat st;
+        if(fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(GraphBinHeader)){
+            close(fd);
+            throw std::runtime_error("Not a binary graph: " + path);
+        }
+        size = st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(p == MAP_FAILED) throw std::runtime_error("Cannot mmap " + path);
+        data = static_cast<const uint8_t*>(p);
+
+        // Секция одна: раскраска или цикл, оба флага сразу — повреждённый файл
+        const GraphBinHeader& h = header();
+        const uint32_t both = GraphBinHeader::HAS_COLORS | GraphBinHeader::HAS_CYCLE;
+        uint64_t extra = (h.flags & GraphBinHeader::HAS_COLORS) ? h.n
+                       : (h.flags & GraphBinHeader::HAS_CYCLE) ? h.n*sizeof(uint32_t) : 0;
+        bool ok = std::memcmp(h.magic, graphBinMagic(), 4) == 0 && (h.flags & both) != both && h.n <= UINT32_MAX &&
+                  h.edgesOffset >= sizeof(GraphBinHeader) && h.edgesOffset % 8 == 0 && h.edgesOffset <= size &&
+                  h.m <= (size - h.edgesOffset)/sizeof(GraphEdge) &&
+                  (extra == 0 || (h.extraOffset >= h.edgesOffset + h.m*sizeof(GraphEdge) &&
+                                  h.extraOffset <= size && extra <= size - h.extraOffset));
+        if(!ok){
+            munmap(const_cast<uint8_t*>(data), size);
+            throw std::runtime_error("Corrupted binary graph: " + path);
+        }
+        // Рёбра читаются подряд один раз — подсказка ядру читать вперёд
+        madvise(const_cast<uint8_t*>(data), size, MADV_SEQUENTIAL);
+    }
+    ~MappedGraph(){ munmap(const_cast<uint8_t*>(data), size); }
+    MappedGraph(const MappedGraph&) = delete;
+    MappedGraph& operator=(const MappedGraph&) = delete;
+
+    const GraphBinHeader& header() const { return *reinterpret_cast<const GraphBinHeader*>(data); }
+    uint64_t n() const { return header().n; }
+    uint64_t m() const { return header().m; }
+    const GraphEdge* edges() const { return reinterpret_cast<const GraphEdge*>(data + header().edgesOffset); }
+    // nullptr, если секции нет
+    const uint8_t* colors() const {
+        return (header().flags & GraphBinHeader::HAS_COLORS) ? data + header().extraOffset : nullptr;
+    }
+    const uint32_t* cycle() const {
+        return (header().flags & GraphBinHeader::HAS_CYCLE)
+             ? reinterpret_cast<const uint32_t*>(data + header().extraOffset) : nullptr;
+    }
+
+private:
+    const uint8_t* data{};
+    size_t size{};
+};
+
+// Потоковая запись: заголовок сразу (m известно заранее), затем рёбра через буфер,
+// в конце — необязательная секция. finish() проверяет, что записано ровно m рёбер.
+class GraphBinWriter {
+public:
+    GraphBinWriter(const std::string& p, uint64_t n, uint64_t m) : path(p) {
+        f = std::fopen(path.c_str(), "wb");
+        if(!f) throw std::runtime_error("Cannot create " + path);
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, graphBinMagic(), 4);
+        h.n = n;
+        h.m = m;
+        h.edgesOffset = sizeof(GraphBinHeader);
+        std::fwrite(&h, sizeof(h), 1, f);
+        buf.reserve(1 << 16);
+    }
+    ~GraphBinWriter(){ if(f) std::fclose(f); }
+    GraphBinWriter(const GraphBinWriter&) = delete;
+    GraphBinWriter& operator=(const GraphBinWriter&) = delete;
+
+    void addEdge(uint32_t u, uint32_t v){
+        buf.push_back({u, v});
+        if(buf.size() == buf.capacity()) flush();
+        written++;
+    }
+    void finish(const uint8_t* colors = nullptr, const uint32_t* cycle = nullptr){
+        flush();
+        if(written != h.m) throw std::runtime_error("Edge count mismatch in " + path);
+        if(colors || cycle){
+            h.extraOffset = h.edgesOffset + h.m*sizeof(GraphEdge);
+            h.flags = colors ? GraphBinHeader::HAS_COLORS : GraphBinHeader::HAS_CYCLE;
+            if(colors) std::fwrite(colors, 1, h.n, f);
+            else std::fwrite(cycle, sizeof(uint32_t), h.n, f);
+            std::fseek(f, 0, SEEK_SET);
+            std::fwrite(&h, sizeof(h), 1, f);
+        }
+        bool ok = !std::ferror(f);
+        ok = std::fclose(f) == 0 && ok;
+        f = nullptr;
+        if(!ok) throw std::runtime_error("Cannot write " + path);
+    }
+
+private:
+    std::string path;
+    FILE* f{};
+    GraphBinHeader h;
+    std::vector<GraphEdge> buf;
+    uint64_t written{};
+
+    void flush(){
+        std::fwrite(buf.data(), sizeof(GraphEdge), buf.size(), f);
+        buf.clear();
+    }
+};
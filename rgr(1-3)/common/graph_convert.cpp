@@ -0,0 +1,123 @@
+// Преобразование графа между текстовым форматом rgr-1/rgr-2 и двоичным (graph_bin.hpp)
+#include "graph_bin.hpp"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Чтение целых чисел из текста через большой буфер: на сотнях миллионов рёбер
+// ifstream >> работает минуты
+class NumberReader {
+public:
+    explicit NumberReader(const std::string& path) : f(std::fopen(path.c_str(), "rb")), buf(1 << 20) {
+        if(!f) throw std::runtime_error("Cannot open " + path);
+    }
+    ~NumberReader(){ std::fclose(f); }
+
+    bool next(uint64_t& x){
+        int c = get();
+        while(c != EOF && (c < '0' || c > '9')) c = get();
+        if(c == EOF) return false;
+        x = 0;
+        for(; c >= '0' && c <= '9'; c = get()) x = x*10 + (c - '0');
+        return true;
+    }
+    uint64_t need(const char* what){
+        uint64_t x;
+        if(!next(x)) throw std::runtime_error(std::string("Unexpected end of file: expected ") + what);
+        return x;
+    }
+
+private:
+    FILE* f;
+    std::vector<char> buf;
+    size_t pos{}, len{};
+
+    int get(){
+        if(pos == len){
+            len = std::fread(buf.data(), 1, buf.size(), f);
+            pos = 0;
+            if(len == 0) return EOF;
+        }
+        return (unsigned char)buf[pos++];
+    }
+};
+
+static uint32_t vertex(uint64_t v, uint64_t n){
+    if(v < 1 || v > n) throw std::runtime_error("Vertex out of range: " + std::to_string(v));
+    return uint32_t(v - 1);
+}
+
+static void toBin(const std::string& in, const std::string& out, const std::string& mode, const std::string& cycleFile){
+    NumberReader r(in);
+    uint64_t n = r.need("n"), m = r.need("m");
+    if(n == 0 || n > UINT32_MAX) throw std::runtime_error("Bad vertex count");
+    GraphBinWriter w(out, n, m);
+    for(uint64_t i=0;i<m;i++){
+        uint32_t u = vertex(r.need("edge"), n);
+        w.addEdge(u, vertex(r.need("edge"), n));
+    }
+
+    if(mode == "--colors"){
+        std::vector<uint8_t> colors(n);
+        for(auto& c : colors){
+            uint64_t x = r.need("color");
+            if(x < 1 || x > 3) throw std::runtime_error("Color must be 1, 2 or 3");
+            c = uint8_t(x);
+        }
+        w.finish(colors.data());
+    } else if(mode == "--cycle"){
+        NumberReader cr(cycleFile);
+        std::vector<uint32_t> cycle(n);
+        for(auto& v : cycle) v = vertex(cr.need("cycle vertex"), n);
+        w.finish(nullptr, cycle.data());
+    } else {
+        w.finish();
+    }
+}
+
+static void toText(const std::string& in, const std::string& out, const std::string& cycleFile){
+    MappedGraph g(in);
+    FILE* f = std::fopen(out.c_str(), "w");
+    if(!f) throw std::runtime_error("Cannot create " + out);
+    std::fprintf(f, "%llu %llu\n", (unsigned long long)g.n(), (unsigned long long)g.m());
+    const GraphEdge* e = g.edges();
+    for(uint64_t i=0;i<g.m();i++) std::fprintf(f, "%u %u\n", e[i].u + 1, e[i].v + 1);
+    if(const uint8_t* c = g.colors())
+        for(uint64_t i=0;i<g.n();i++) std::fprintf(f, "%u%c", c[i], i+1 == g.n() ? '\n' : ' ');
+    bool ok = std::fclose(f) == 0;
+
+    if(const uint32_t* cyc = g.cycle()){
+        if(cycleFile.empty()){
+            std::cerr << "Warning: the graph has a cycle section, pass cycle.txt to extract it\n";
+        } else {
+            FILE* cf = std::fopen(cycleFile.c_str(), "w");
+            if(!cf) throw std::runtime_error("Cannot create " + cycleFile);
+            for(uint64_t i=0;i<g.n();i++) std::fprintf(cf, "%u ", cyc[i] + 1);
+            ok = std::fclose(cf) == 0 && ok;
+        }
+    }
+    if(!ok) throw std::runtime_error("Cannot write " + out);
+}
+
+int main(int argc, char** argv){
+    std::vector<std::string> args(argv + 1, argv + argc);
+    try {
+        if(args.size() >= 3 && args[0] == "to-bin"){
+            std::string mode = args.size() >= 4 ? args[3] : "";
+            if(mode == "--cycle" && args.size() < 5) throw std::runtime_error("--cycle needs cycle.txt");
+            if(!mode.empty() && mode != "--colors" && mode != "--cycle") throw std::runtime_error("Unknown option: " + mode);
+            toBin(args[1], args[2], mode, mode == "--cycle" ? args[4] : "");
+        } else if(args.size() >= 3 && args[0] == "to-text"){
+            toText(args[1], args[2], args.size() >= 4 ? args[3] : "");
+        } else {
+            std::cout << "Usage: graph_convert to-bin graph.txt graph.bin [--colors | --cycle cycle.txt]\n"
+                      << "       graph_convert to-text graph.bin graph.txt [cycle.txt]\n";
+            return 1;
+        }
+    } catch(const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// f(i, t) для всех i из [0, count) в threads потоках (0 — по числу ядер), t — номер потока
+// для его личных буферов. Индексы раздаются общим атомарным счётчиком; первое исключение
+// из потока пробрасывается после их завершения.
+template<class F>
+void parallelFor(size_t count, unsigned threads, F f){
+    if(threads == 0) threads = std::thread::hardware_concurrency();
+    if(threads == 0) threads = 1;
+    if(threads > count) threads = unsigned(count);
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    auto worker = [&](unsigned t){
+        try {
+            for(size_t i=next++; i<count && !failed; i=next++) f(i, t);
+        } catch(...) {
+            if(!failed.exchange(true)) error = std::current_exception();
+        }
+    };
+    if(threads <= 1){
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for(unsigned t=1;t<threads;t++) pool.emplace_back(worker, t);
+        worker(0);
+        for(auto& th : pool) th.join();
+    }
+    if(error) std::rethrow_exception(error);
+}
+
+inline unsigned threadCount(unsigned threads){
+    if(threads == 0) threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
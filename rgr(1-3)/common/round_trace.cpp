@@ -0,0 +1,105 @@
+#include "round_trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+// Счётчики ведёт замена operator new в alloc_count.cpp; её линкуют только программы,
+// печатающие сводку раундов. Без неё выделения не считаются и здесь всегда нули.
+__attribute__((weak)) AllocStats threadAllocs(){ return {0, 0}; }
+
+const char* phaseName(Phase p){
+    static const char* names[PHASES] = {"permute", "commit", "challenge", "open", "verify"};
+    return names[int(p)];
+}
+
+// Корзина: значения меньше 16 нс — каждое своя, дальше по 8 корзин на каждое удвоение
+static int bucketOf(uint64_t ns){
+    if(ns < 16) return int(ns);
+    int e = 63 - __builtin_clzll(ns);
+    return 16 + (e - 4)*8 + int((ns >> (e - 3)) & 7);
+}
+
+// Середина корзины, мс
+static double bucketValue(int b){
+    if(b < 16) return b * 1e-6;
+    int e = (b - 16) / 8 + 4, sub = (b - 16) % 8;
+    double lo = double(uint64_t(8 + sub) << (e - 3)), width = double(uint64_t(1) << (e - 3));
+    return (lo + width / 2) * 1e-6;
+}
+
+RoundTrace::RoundTrace(size_t rounds, unsigned threads, bool keepRecords)
+    : shards(threads ? threads : 1), keep(keepRecords) {
+    if(keep) records.resize(rounds);
+}
+
+void RoundTrace::add(const RoundRecord& r, unsigned thread){
+    Shard& s = shards[thread];
+    double round = 0;
+    for(int p=0;p<ROWS;p++){
+        double ms = p < PHASES ? r.ms[p] : round;
+        if(p < PHASES) round += ms;
+        s.hist[size_t(p)*BUCKETS + bucketOf(uint64_t(ms * 1e6))]++;
+        s.totalMs[p] += ms;
+    }
+    s.rounds++;
+    s.passed += r.ok;
+    s.allocs += r.allocs;
+    s.allocBytes += r.allocBytes;
+    s.committed += r.committed;
+    s.transferred += r.transferred;
+    if(keep && r.round >= 1 && r.round <= records.size()) records[r.round - 1] = r;
+}
+
+void RoundTrace::summary(std::ostream& out) const {
+    Shard all;
+    for(const Shard& s : shards){
+        for(size_t i=0;i<all.hist.size();i++) all.hist[i] += s.hist[i];
+        for(int p=0;p<ROWS;p++) all.totalMs[p] += s.totalMs[p];
+        all.rounds += s.rounds;
+        all.passed += s.passed;
+        all.allocs += s.allocs;
+        all.allocBytes += s.allocBytes;
+        all.committed += s.committed;
+        all.transferred += s.transferred;
+    }
+    uint64_t n = all.rounds;
+
+    // Ближайший ранг: корзина, в которой лежит значение с номером ⌈q·n⌉
+    auto percentile = [&](int row, double q){
+        uint64_t k = std::max<uint64_t>(1, uint64_t(std::ceil(q * n))), seen = 0;
+        const uint64_t* h = &all.hist[size_t(row)*BUCKETS];
+        for(int b=0;b<BUCKETS;b++)
+            if((seen += h[b]) >= k) return bucketValue(b);
+        return 0.0;
+    };
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-10s %10s %10s %10s %12s\n", "phase, ms", "p50", "p99", "mean", "total");
+    out << line;
+    for(int p=0;p<ROWS;p++){
+        const char* name = p < PHASES ? phaseName(Phase(p)) : "round";
+        std::snprintf(line, sizeof(line), "%-10s %10.4f %10.4f %10.4f %12.3f\n", name, percentile(p, 0.5),
+                      percentile(p, 0.99), n ? all.totalMs[p] / n : 0.0, all.totalMs[p]);
+        out << line;
+    }
+    out << "rounds: " << n << " (" << all.passed << " ok), allocations: " << all.allocs << " (" << all.allocBytes
+        << " bytes), committed: " << all.committed << " bytes, transferred: " << all.transferred << " bytes\n";
+}
+
+void RoundTrace::writeCsv(const std::string& path) const {
+    if(!keep) throw std::runtime_error("RoundTrace: per-round records were not kept");
+    FILE* f = std::fopen(path.c_str(), "w");
+    if(!f) throw std::runtime_error("Cannot create " + path);
+    std::fprintf(f, "round");
+    for(int p=0;p<PHASES;p++) std::fprintf(f, ",%s_ms", phaseName(Phase(p)));
+    std::fprintf(f, ",allocs,alloc_bytes,committed_bytes,transferred_bytes,ok\n");
+    for(const RoundRecord& r : records){
+        std::fprintf(f, "%llu", (unsigned long long)r.round);
+        for(double x : r.ms) std::fprintf(f, ",%.6f", x);
+        std::fprintf(f, ",%llu,%llu,%llu,%llu,%d\n", (unsigned long long)r.allocs, (unsigned long long)r.allocBytes,
+                     (unsigned long long)r.committed, (unsigned long long)r.transferred, int(r.ok));
+    }
+    bool ok = !std::ferror(f);
+    if(std::fclose(f) != 0 || !ok) throw std::runtime_error("Write error: " + path);
+}
@@ -0,0 +1,95 @@
+#pragma once
+// Замеры раундов ZKP, общие для rgr-1 и rgr-2: время фаз раунда, выделения памяти,
+// объём закоммиченных и переданных данных. Сводка — p50/p99 по фазам, трасса — CSV,
+// строка на раунд. Подсчёт выделений — через замену глобального operator new в
+// round_trace.cpp. Счётчики свои у каждого потока, поэтому раунды в разных потоках
+// не смешиваются; выделения во вспомогательных потоках раунда (parallelFor внутри
+// коммита) в его запись не попадают.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class Phase { Permute, Commit, Challenge, Open, Verify };
+constexpr int PHASES = 5;
+
+const char* phaseName(Phase p);
+
+// Выделения памяти текущим потоком с его запуска; считаются, только если в программу
+// слинкован alloc_count.cpp, иначе нули
+struct AllocStats {
+    uint64_t count, bytes;
+};
+AllocStats threadAllocs();
+
+struct RoundRecord {
+    uint64_t round{};
+    double ms[PHASES]{};
+    uint64_t allocs{}, allocBytes{};
+    uint64_t committed{};   // байт данных под коммитами раунда
+    uint64_t transferred{}; // байт, переданных между сторонами
+    bool ok{};
+};
+
+// Сводка копится в гистограммах фиксированного размера — по одной на поток, без
+// блокировок, память не зависит от числа раундов. Перцентили берутся по корзинам
+// гистограммы (логарифмическая шкала, 8 корзин на удвоение, погрешность до ~6%).
+// Записи каждого раунда хранятся, только если нужна CSV-трасса (keepRecords).
+class RoundTrace {
+public:
+    RoundTrace(size_t rounds, unsigned threads, bool keepRecords);
+
+    void add(const RoundRecord& r, unsigned thread); // r.round — номер раунда с 1
+    void summary(std::ostream& out) const;
+    void writeCsv(const std::string& path) const; // std::runtime_error при ошибке записи или без keepRecords
+
+    static constexpr int ROWS = PHASES + 1;   // фазы и раунд целиком
+    static constexpr int BUCKETS = 16 + 60*8; // время в наносекундах, до 2^64
+
+private:
+    struct alignas(64) Shard { // потоки пишут в соседние — без общей кеш-линии
+        std::vector<uint64_t> hist = std::vector<uint64_t>(size_t(ROWS) * BUCKETS);
+        double totalMs[ROWS]{};
+        uint64_t rounds{}, passed{}, allocs{}, allocBytes{}, committed{}, transferred{};
+    };
+    std::vector<Shard> shards;
+    std::vector<RoundRecord> records;
+    bool keep;
+};
+
+// Замер одного раунда: mark(p) закрывает фазу p временем с предыдущей отметки,
+// finish() дописывает выделения памяти за раунд и передаёт запись в трассу
+class RoundProbe {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RoundProbe(RoundTrace& trace, uint64_t round, unsigned thread = 0)
+        : trace(trace), thread(thread), last(Clock::now()), start(threadAllocs()) {
+        r.round = round;
+    }
+
+    void mark(Phase p){
+        Clock::time_point now = Clock::now();
+        r.ms[int(p)] += std::chrono::duration<double, std::milli>(now - last).count();
+        last = now;
+    }
+
+    void finish(uint64_t committed, uint64_t transferred, bool ok){
+        AllocStats end = threadAllocs();
+        r.allocs = end.count - start.count;
+        r.allocBytes = end.bytes - start.bytes;
+        r.committed = committed;
+        r.transferred = transferred;
+        r.ok = ok;
+        trace.add(r, thread);
+    }
+
+private:
+    RoundTrace& trace;
+    unsigned thread;
+    RoundRecord r;
+    Clock::time_point last;
+    AllocStats start;
+};
@@ -0,0 +1,67 @@
+#include "commitment.hpp"
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <cstring>
+#include <stdexcept>
+
+static const size_t INPUT_LEN = 16 + 1;
+static const size_t BLOCK_LEN = 64;
+
+// Дополнение SHA-256 для сообщения из INPUT_LEN байт: 0x80, нули, длина в битах (big-endian)
+static void padBlock(uint8_t* block) {
+    std::memset(block + INPUT_LEN, 0, BLOCK_LEN - INPUT_LEN);
+    block[INPUT_LEN] = 0x80;
+    block[BLOCK_LEN - 2] = uint8_t((INPUT_LEN * 8) >> 8);
+    block[BLOCK_LEN - 1] = uint8_t(INPUT_LEN * 8);
+}
+
+static Digest compress(const uint8_t* block) {
+    static const SHA256_CTX iv = [] {
+        SHA256_CTX c;
+        SHA256_Init(&c);
+        return c;
+    }();
+    SHA256_CTX c = iv;
+    SHA256_Transform(&c, block);
+    Digest d;
+    for (int k = 0; k < 8; ++k) {
+        d[4 * k] = uint8_t(c.h[k] >> 24);
+        d[4 * k + 1] = uint8_t(c.h[k] >> 16);
+        d[4 * k + 2] = uint8_t(c.h[k] >> 8);
+        d[4 * k + 3] = uint8_t(c.h[k]);
+    }
+    return d;
+}
+
+void ColorCommitments::commit(const std::vector<uint8_t>& colors) {
+    size_t n = colors.size();
+    if (blocks.size() != n * BLOCK_LEN) {
+        blocks.resize(n * BLOCK_LEN);
+        nonces.resize(n * 16);
+        commits.resize(n);
+        for (size_t v = 0; v < n; ++v) padBlock(&blocks[v * BLOCK_LEN]);
+    }
+    if (RAND_bytes(nonces.data(), int(nonces.size())) != 1) throw std::runtime_error("RAND_bytes failed");
+
+    for (size_t v = 0; v < n; ++v) {
+        uint8_t* block = &blocks[v * BLOCK_LEN];
+        std::memcpy(block, &nonces[v * 16], 16);
+        block[16] = colors[v];
+    }
+    for (size_t v = 0; v < n; ++v) commits[v] = compress(&blocks[v * BLOCK_LEN]);
+}
+
+ColorOpening ColorCommitments::open(size_t v) const {
+    ColorOpening o;
+    o.color = blocks[v * BLOCK_LEN + 16];
+    std::memcpy(o.nonce.data(), &nonces[v * 16], 16);
+    return o;
+}
+
+Digest ColorCommitments::hash(const ColorOpening& o) {
+    uint8_t block[BLOCK_LEN];
+    std::memcpy(block, o.nonce.data(), 16);
+    block[16] = o.color;
+    padBlock(block);
+    return compress(block);
+}
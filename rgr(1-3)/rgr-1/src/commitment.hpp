@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using Digest = std::array<uint8_t, 32>;
+using Nonce = std::array<uint8_t, 16>;
+
+// Открытие коммита вершины: цвет и его nonce
+struct ColorOpening {
+    uint8_t color;
+    Nonce nonce;
+};
+
+// Коммиты цветов всех вершин: c_v = SHA-256(nonce_v ‖ color_v), nonce — 16 байт от RAND_bytes.
+// Вход каждой вершины (17 байт) занимает ровно один блок SHA-256, поэтому блоки с готовым
+// дополнением лежат подряд в одном буфере и сжимаются по одному вызову SHA256_Transform
+// без Init/Update/Final на каждую вершину. Буферы переиспользуются между раундами.
+class ColorCommitments {
+public:
+    void commit(const std::vector<uint8_t>& colors); // новые nonce и коммиты для всех вершин
+
+    const std::vector<Digest>& digests() const { return commits; } // уходят проверяющему
+    ColorOpening open(size_t v) const;
+
+    static Digest hash(const ColorOpening& o); // проверяющий пересчитывает коммит
+
+private:
+    std::vector<uint8_t> nonces; // n × 16
+    std::vector<uint8_t> blocks; // n × 64
+    std::vector<Digest> commits;
+};
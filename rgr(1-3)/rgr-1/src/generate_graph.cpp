@@ -1,13 +1,21 @@
 /**
  * Генератор случайного графа с гарантированной корректной 3-раскраской.
- * 
+ *
  * Алгоритм:
  * 1. Задаём n — число вершин.
  * 2. Случайно назначаем каждой вершине цвет из {1,2,3}.
- * 3. Добавляем рёбра ТОЛЬКО между вершинами с разными цветами.
- * 4. Гарантируем, что граф связный (опционально — для наглядности).
- * 
- * Использование: ./generate_graph <n> <m> <output_file>
+ * 3. Выбираем m различных рёбер ТОЛЬКО между вершинами с разными цветами.
+ *
+ * Допустимые пары (u, v), u < v, нумеруются подряд: сначала все пары с u = 0, затем с u = 1
+ * и т. д. Выбираются m различных номеров, каждый номер переводится в ребро — список всех
+ * возможных рёбер (O(n^2)) не строится, память O(n + m).
+ *
+ * В параллельном режиме вершины делятся на диапазоны с примерно равным числом допустимых
+ * пар, каждый поток выбирает рёбра своего диапазона и пишет их во временный файл,
+ * затем части склеиваются по порядку.
+ *
+ * Использование: ./generate_graph <n> <m> <output_file> [-j потоков]
+ * Если имя файла оканчивается на .bin, граф пишется в двоичном формате (common/graph_bin.hpp).
  */
 
 #include <iostream>
@@ -15,78 +23,256 @@
 #include <random>
 #include <fstream>
 #include <algorithm>
-#include <set>
+#include <cstdio>
+#include <thread>
+#include "graph_bin.hpp"
 
 using namespace std;
 
 random_device rd;
-mt19937 gen(rd());
 
-int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        cerr << "Использование: " << argv[0] << " <n> <m> <файл_вывода>\n";
-        return 1;
+// Нумерация допустимых пар: pairsBefore[u] — число пар с меньшей вершиной < u
+struct PairIndex {
+    int n;
+    const vector<uint8_t>& color;
+    vector<uint32_t> colorBefore[4]; // colorBefore[c][x] — вершин цвета c среди 0..x-1
+    vector<uint64_t> pairsBefore;
+
+    PairIndex(int nn, const vector<uint8_t>& col) : n(nn), color(col), pairsBefore(nn + 1, 0) {
+        for (int c = 1; c <= 3; ++c) colorBefore[c].assign(n + 1, 0);
+        for (int x = 0; x < n; ++x)
+            for (int c = 1; c <= 3; ++c) colorBefore[c][x + 1] = colorBefore[c][x] + (color[x] == c);
+        for (int u = 0; u < n; ++u) pairsBefore[u + 1] = pairsBefore[u] + partners(u);
+    }
+
+    uint64_t total() const { return pairsBefore[n]; }
+
+    // Вершины v > u другого цвета
+    uint64_t partners(int u) const {
+        int c = color[u];
+        return uint64_t(n - 1 - u) - (colorBefore[c][n] - colorBefore[c][u + 1]);
+    }
+
+    // j-я (с 0) вершина v > u другого цвета — двоичный поиск по числу таких вершин в (u, x]
+    int partner(int u, uint64_t j) const {
+        int c = color[u];
+        int lo = u + 1, hi = n - 1;
+        while (lo < hi) {
+            int x = lo + (hi - lo) / 2;
+            uint64_t cnt = uint64_t(x - u) - (colorBefore[c][x + 1] - colorBefore[c][u + 1]);
+            if (cnt >= j + 1) hi = x;
+            else lo = x + 1;
+        }
+        return lo;
+    }
+};
+
+// Выходной поток части: текст ("u v\n", нумерация с 1) или массив GraphEdge
+class EdgeSink {
+public:
+    EdgeSink(FILE* f, bool binary) : file(f), bin(binary) { buf.reserve(1 << 20); }
+    ~EdgeSink() { flush(); }
+
+    void add(uint32_t u, uint32_t v) {
+        if (bin) {
+            GraphEdge e{u, v};
+            const char* p = reinterpret_cast<const char*>(&e);
+            buf.insert(buf.end(), p, p + sizeof(e));
+        } else {
+            char line[24];
+            char* end = putNumber(line, u + 1);
+            *end++ = ' ';
+            end = putNumber(end, v + 1);
+            *end++ = '\n';
+            buf.insert(buf.end(), line, end);
+        }
+        if (buf.size() >= (1 << 20)) flush();
+    }
+
+    void flush() {
+        fwrite(buf.data(), 1, buf.size(), file);
+        buf.clear();
+    }
+
+private:
+    FILE* file;
+    bool bin;
+    vector<char> buf;
+
+    static char* putNumber(char* p, uint32_t x) {
+        char digits[10];
+        int k = 0;
+        do digits[k++] = char('0' + x % 10); while (x /= 10);
+        while (k) *p++ = digits[--k];
+        return p;
+    }
+};
+
+// count различных номеров из [lo, hi) в порядке возрастания. Если нужно больше половины
+// диапазона, выбираются номера, которые НЕ войдут, — число повторных попыток остаётся малым
+static void sampleIndices(uint64_t lo, uint64_t hi, uint64_t count, mt19937_64& rng,
+                          vector<uint64_t>& out) {
+    uint64_t range = hi - lo;
+    bool complement = count > range / 2;
+    uint64_t need = complement ? range - count : count;
+
+    vector<uint64_t> chosen;
+    chosen.reserve(need);
+    uniform_int_distribution<uint64_t> dist(lo, hi - 1);
+    while (chosen.size() < need) {
+        for (uint64_t k = need - chosen.size(); k > 0; --k) chosen.push_back(dist(rng));
+        sort(chosen.begin(), chosen.end());
+        chosen.erase(unique(chosen.begin(), chosen.end()), chosen.end());
+    }
+
+    out.clear();
+    if (!complement) {
+        out.swap(chosen);
+        return;
+    }
+    out.reserve(count);
+    size_t k = 0;
+    for (uint64_t x = lo; x < hi; ++x) {
+        if (k < chosen.size() && chosen[k] == x) ++k;
+        else out.push_back(x);
     }
+}
 
-    int n = stoi(argv[1]);
-    int m = stoi(argv[2]);
-    string outfile = argv[3];
+// Рёбра вершин [uFrom, uTo): count номеров из их диапазона пар, переведённых в рёбра
+static void generateShard(const PairIndex& pairs, int uFrom, int uTo, uint64_t count, uint64_t seed,
+                          EdgeSink& sink) {
+    if (count == 0) return;
+    mt19937_64 rng(seed);
+    vector<uint64_t> idx;
+    sampleIndices(pairs.pairsBefore[uFrom], pairs.pairsBefore[uTo], count, rng, idx);
 
-    if (n < 1 || m < 0) {
-        cerr << "Ошибка: n >= 1, m >= 0\n";
+    int u = uFrom;
+    for (uint64_t k : idx) {
+        while (pairs.pairsBefore[u + 1] <= k) ++u;
+        int v = pairs.partner(u, k - pairs.pairsBefore[u]);
+        sink.add(u, v);
+    }
+}
+
+// Копирование части во выходной файл; двоичные части проходят через GraphBinWriter
+static void appendPart(FILE* part, FILE* out, GraphBinWriter* bin) {
+    rewind(part);
+    vector<char> buf(1 << 20);
+    size_t got;
+    while ((got = fread(buf.data(), 1, buf.size(), part)) > 0) {
+        if (bin) {
+            const GraphEdge* e = reinterpret_cast<const GraphEdge*>(buf.data());
+            for (size_t i = 0; i < got / sizeof(GraphEdge); ++i) bin->addEdge(e[i].u, e[i].v);
+        } else {
+            fwrite(buf.data(), 1, got, out);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    unsigned threads = 1;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "-j" && i + 1 < argc) threads = max(1, stoi(argv[++i]));
+        else args.push_back(a);
+    }
+    if (args.size() != 3) {
+        cerr << "Использование: " << argv[0] << " <n> <m> <файл_вывода> [-j потоков]\n";
         return 1;
     }
 
-    // Максимальное число рёбер между разными цветами
-    // В худшем случае — полный 3-дольный граф: до ~ (2/3)*n^2 рёбер
-    if (m > n * (n - 1) / 2) {
-        cerr << "Предупреждение: запрошено слишком много рёбер. Уменьшаем до максимума.\n";
-        m = n * (n - 1) / 2;
+    long long nn = stoll(args[0]);
+    long long mm = stoll(args[1]);
+    string outfile = args[2];
+
+    if (nn < 1 || nn > UINT32_MAX / 2 || mm < 0) {
+        cerr << "Ошибка: 1 <= n <= " << UINT32_MAX / 2 << ", m >= 0\n";
+        return 1;
     }
+    int n = nn;
+    uint64_t m = mm;
 
     // Шаг 1: генерируем случайную раскраску
-    vector<int> color(n);
+    mt19937_64 gen(rd());
+    vector<uint8_t> color(n);
     uniform_int_distribution<> colorDist(1, 3);
     for (int i = 0; i < n; ++i) {
         color[i] = colorDist(gen);
     }
 
-    // Шаг 2: собираем все возможные рёбра между разными цветами
-    vector<pair<int, int>> possibleEdges;
-    for (int i = 0; i < n; ++i) {
-        for (int j = i + 1; j < n; ++j) {
-            if (color[i] != color[j]) {
-                possibleEdges.emplace_back(i, j);
-            }
-        }
-    }
-
-    if ((int)possibleEdges.size() < m) {
+    // Шаг 2: нумерация всех рёбер между разными цветами
+    PairIndex pairs(n, color);
+    if (pairs.total() < m) {
         cerr << "Предупреждение: невозможно создать " << m << " рёбер с текущей раскраской.\n";
-        cerr << "Максимум: " << possibleEdges.size() << ". Используем максимум.\n";
-        m = possibleEdges.size();
+        cerr << "Максимум: " << pairs.total() << ". Используем максимум.\n";
+        m = pairs.total();
     }
 
-    // Перемешиваем и берём первые m рёбер
-    shuffle(possibleEdges.begin(), possibleEdges.end(), gen);
-    possibleEdges.resize(m);
-
-    // Шаг 3: сохраняем в файл
-    ofstream out(outfile);
-    if (!out.is_open()) {
-        cerr << "Не удалось создать файл '" << outfile << "'\n";
-        return 1;
+    // Шаг 3: части — диапазоны вершин с примерно равным числом пар; рёбер в части
+    // пропорционально её числу пар, остаток раздаётся по одному
+    threads = unsigned(min<uint64_t>(threads, max(1, n)));
+    vector<int> bound(threads + 1, n);
+    bound[0] = 0;
+    for (unsigned t = 1; t < threads; ++t) {
+        uint64_t target = (unsigned __int128)pairs.total() * t / threads;
+        bound[t] = upper_bound(pairs.pairsBefore.begin(), pairs.pairsBefore.end(), target) -
+                   pairs.pairsBefore.begin() - 1;
+        bound[t] = max(bound[t], bound[t - 1]);
+    }
+    vector<uint64_t> count(threads);
+    uint64_t assigned = 0;
+    for (unsigned t = 0; t < threads; ++t) {
+        uint64_t cap = pairs.pairsBefore[bound[t + 1]] - pairs.pairsBefore[bound[t]];
+        count[t] = pairs.total() ? uint64_t((unsigned __int128)m * cap / pairs.total()) : 0;
+        assigned += count[t];
+    }
+    for (unsigned t = 0; assigned < m; t = (t + 1) % threads) {
+        uint64_t cap = pairs.pairsBefore[bound[t + 1]] - pairs.pairsBefore[bound[t]];
+        if (count[t] < cap) ++count[t], ++assigned;
     }
 
-    out << n << " " << m << "\n";
-    for (auto [u, v] : possibleEdges) {
-        out << u + 1 << " " << v + 1 << "\n"; // 1-based
+    // Шаг 4: части генерируются параллельно во временные файлы
+    bool binary = outfile.size() > 4 && outfile.compare(outfile.size() - 4, 4, ".bin") == 0;
+    vector<FILE*> parts(threads);
+    for (auto& p : parts) {
+        p = tmpfile();
+        if (!p) {
+            cerr << "Ошибка: не удалось создать временный файл\n";
+            return 1;
+        }
     }
-    for (int i = 0; i < n; ++i) {
-        out << color[i] << (i == n - 1 ? "\n" : " ");
+    uint64_t seed = gen();
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            EdgeSink sink(parts[t], binary);
+            generateShard(pairs, bound[t], bound[t + 1], count[t], seed + t, sink);
+        });
+    }
+    for (auto& th : pool) th.join();
+
+    // Шаг 5: сохраняем в файл
+    try {
+        if (binary) {
+            GraphBinWriter w(outfile, n, m);
+            for (FILE* p : parts) appendPart(p, nullptr, &w);
+            w.finish(color.data());
+        } else {
+            FILE* out = fopen(outfile.c_str(), "w");
+            if (!out) throw runtime_error("не удалось создать файл '" + outfile + "'");
+            fprintf(out, "%d %llu\n", n, (unsigned long long)m);
+            for (FILE* p : parts) appendPart(p, out, nullptr);
+            for (int i = 0; i < n; ++i) fprintf(out, "%d%c", color[i], i == n - 1 ? '\n' : ' ');
+            bool ok = !ferror(out);
+            if (fclose(out) != 0 || !ok) throw runtime_error("ошибка записи в '" + outfile + "'");
+        }
+    } catch (const exception& e) {
+        cerr << "Ошибка: " << e.what() << "\n";
+        return 1;
     }
-    out.close();
+    for (FILE* p : parts) fclose(p);
 
     cout << "Граф с " << n << " вершинами и " << m << " рёбрами сохранён в '" << outfile << "'\n";
     return 0;
-}
\ No newline at end of file
+}
@@ -9,6 +9,13 @@
  * um vm
  * c1 c2 ... cn   (цвета: 1, 2 или 3)
  * 
+ * или двоичный файл с секцией раскраски (common/graph_bin.hpp) —
+ * он отображается в память и читается без разбора текста.
+ * 
+ * В каждом раунде Prover коммитит все n переставленных цветов (commitment.hpp),
+ * Verifier выбирает ребро и получает открытия только его концов.
+ * Раунды независимы и выполняются параллельно.
+ * 
  * Вариант: 1 (Раскраска графа)
  */
 
@@ -18,56 +25,120 @@
 #include <random>
 #include <algorithm>
 #include <string>
+#include <memory>
+#include <chrono>
+#include "graph_bin.hpp"
+#include "parallel.hpp"
+#include "commitment.hpp"
+#include "round_trace.hpp"
 
 using namespace std;
 
-// Глобальный генератор случайных чисел
+// Источник зёрен для генераторов потоков
 random_device rd;
-mt19937 gen(rd());
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        cerr << "Использование: " << argv[0] << " <файл_графа>\n";
-        return 1;
+    // -k K — раундов K·m (вероятность обмана ≤ (1−1/m)^(K·m) ≈ e^(−K)), -r R — ровно R раундов,
+    // -t T — потоков (0 — по числу ядер), --trace file.csv — замеры каждого раунда в CSV
+    string filename, traceFile;
+    int k = 20;
+    size_t explicitRounds = 0;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "-k" && i + 1 < argc) k = max(1, stoi(argv[++i]));
+        else if (a == "-r" && i + 1 < argc) explicitRounds = max(1LL, stoll(argv[++i]));
+        else if (a == "-t" && i + 1 < argc) threads = max(0, stoi(argv[++i]));
+        else if (a == "--trace" && i + 1 < argc) traceFile = argv[++i];
+        else if (filename.empty()) filename = a;
+        else {
+            filename.clear();
+            break;
+        }
     }
-
-    string filename = argv[1];
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Ошибка: не удалось открыть файл '" << filename << "'\n";
+    if (filename.empty()) {
+        cerr << "Использование: " << argv[0] << " <файл_графа> [-k K | -r раундов] [-t потоков]"
+             << " [--trace файл.csv]\n";
         return 1;
     }
 
-    int n, m;
-    file >> n >> m;
+    // Рёбра и цвета: указатели либо в отображённый файл, либо в векторы с разобранным текстом
+    size_t n, m;
+    const GraphEdge* edges;
+    const uint8_t* trueColoring;
+    unique_ptr<MappedGraph> mapped;
+    vector<GraphEdge> edgeStore;
+    vector<uint8_t> colorStore;
+
+    if (isGraphBin(filename)) {
+        try {
+            mapped = make_unique<MappedGraph>(filename);
+        } catch (const exception& e) {
+            cerr << "Ошибка: " << e.what() << "\n";
+            return 1;
+        }
+        n = mapped->n();
+        m = mapped->m();
+        edges = mapped->edges();
+        trueColoring = mapped->colors();
+        if (!trueColoring) {
+            cerr << "Ошибка: в файле '" << filename << "' нет раскраски.\n";
+            return 1;
+        }
+    } else {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Ошибка: не удалось открыть файл '" << filename << "'\n";
+            return 1;
+        }
 
-    if (n <= 0 || m <= 0) {
-        cerr << "Ошибка: некорректное количество вершин или рёбер.\n";
-        return 1;
-    }
+        long long nn, mm;
+        file >> nn >> mm;
+        if (nn <= 0 || mm <= 0) {
+            cerr << "Ошибка: некорректное количество вершин или рёбер.\n";
+            return 1;
+        }
+        n = nn;
+        m = mm;
+
+        edgeStore.resize(m);
+        for (auto& e : edgeStore) {
+            long long u, v;
+            file >> u >> v;
+            // Переводим в 0-based индексацию; вне диапазона — заведомо неверная вершина
+            e.u = (u >= 1 && u <= nn) ? uint32_t(u - 1) : UINT32_MAX;
+            e.v = (v >= 1 && v <= nn) ? uint32_t(v - 1) : UINT32_MAX;
+        }
 
-    vector<pair<int, int>> edges;
-    for (int i = 0; i < m; ++i) {
-        int u, v;
-        file >> u >> v;
-        // Переводим в 0-based индексацию
-        edges.emplace_back(u - 1, v - 1);
+        colorStore.resize(n);
+        for (auto& c : colorStore) {
+            int x = 0;
+            file >> x;
+            c = uint8_t(x >= 1 && x <= 3 ? x : 0);
+        }
+        edges = edgeStore.data();
+        trueColoring = colorStore.data();
     }
 
-    vector<int> trueColoring(n);
-    for (int i = 0; i < n; ++i) {
-        file >> trueColoring[i];
+    if (m == 0) {
+        cerr << "Ошибка: некорректное количество вершин или рёбер.\n";
+        return 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
         if (trueColoring[i] < 1 || trueColoring[i] > 3) {
             cerr << "Ошибка: цвет должен быть 1, 2 или 3 (вершина " << i + 1 << ")\n";
             return 1;
         }
     }
-    file.close();
 
     // Проверка корректности раскраски
     bool valid = true;
-    for (const auto& [u, v] : edges) {
-        if (trueColoring[u] == trueColoring[v]) {
+    for (size_t i = 0; i < m; ++i) {
+        if (edges[i].u >= n || edges[i].v >= n) {
+            cerr << "Ошибка: ребро " << i + 1 << " ссылается на несуществующую вершину.\n";
+            return 1;
+        }
+        if (trueColoring[edges[i].u] == trueColoring[edges[i].v]) {
             valid = false;
             break;
         }
@@ -79,46 +150,85 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    size_t rounds = explicitRounds ? explicitRounds : size_t(k) * m;
+    unsigned T = threadCount(threads);
     cout << "Раскраска корректна. Запуск протокола доказательства с нулевым знанием...\n";
     cout << "Количество вершин: " << n << ", рёбер: " << m << "\n";
-    cout << "Число раундов: 30\n\n";
-
-    const int ROUNDS = 30;
-    uniform_int_distribution<> edgeDist(0, m - 1);
-
-    for (int round = 1; round <= ROUNDS; ++round) {
-        // Шаг 1: Prover создаёт случайную перестановку цветов {1,2,3}
-        vector<int> perm = {1, 2, 3};
-        shuffle(perm.begin(), perm.end(), gen);
-
-        // Применяем перестановку к раскраске
-        vector<int> permuted(n);
-        for (int i = 0; i < n; ++i) {
-            permuted[i] = perm[trueColoring[i] - 1];
-        }
-
-        // Шаг 2: Verifier выбирает случайное ребро
-        int idx = edgeDist(gen);
-        int u = edges[idx].first;
-        int v = edges[idx].second;
-
-        // Шаг 3: Prover раскрывает цвета u и v
-        int cu = permuted[u];
-        int cv = permuted[v];
+    cout << "Число раундов: " << rounds << ", потоков: " << T << "\n\n";
+
+    // Личные буферы потоков: переставленная раскраска, коммиты и генераторы сторон
+    vector<vector<uint8_t>> permuted(T, vector<uint8_t>(n));
+    vector<ColorCommitments> commitments(T);
+    vector<mt19937_64> proverRng, verifierRng;
+    for (unsigned t = 0; t < T; ++t) {
+        proverRng.emplace_back((uint64_t(rd()) << 32) | rd());
+        verifierRng.emplace_back((uint64_t(rd()) << 32) | rd());
+    }
 
-        // Шаг 4: Verifier проверяет
-        if (cu == cv) {
-            cout << "Раунд " << round << ": обнаружено совпадение цветов на ребре ("
-                 << u + 1 << ", " << v + 1 << ") → " << cu << " = " << cv << "\n";
-            cout << "Доказательство отклонено.\n";
+    // Коммитятся n пар (nonce, цвет); передаются n хешей, номер ребра и два открытия
+    const uint64_t committed = n * (sizeof(Nonce) + 1);
+    const uint64_t transferred = n * sizeof(Digest) + sizeof(uint64_t) + 2 * (sizeof(Nonce) + 1);
+    RoundTrace trace(rounds, T, !traceFile.empty());
+
+    // Раунды независимы: потоки разбирают их общим счётчиком, каждый раунд —
+    // коммит, challenge, открытие и проверка от начала до конца
+    auto start = chrono::steady_clock::now();
+    try {
+        parallelFor(rounds, T, [&](size_t round, unsigned t) {
+            RoundProbe probe(trace, round + 1, t);
+
+            // Шаг 1: Prover переставляет цвета {1,2,3} и коммитит все n вершин
+            uint8_t perm[3] = {1, 2, 3};
+            shuffle(perm, perm + 3, proverRng[t]);
+            vector<uint8_t>& colors = permuted[t];
+            for (size_t i = 0; i < n; ++i) colors[i] = perm[trueColoring[i] - 1];
+            probe.mark(Phase::Permute);
+            ColorCommitments& prover = commitments[t];
+            prover.commit(colors);
+            const vector<Digest>& received = prover.digests();
+            probe.mark(Phase::Commit);
+
+            // Шаг 2: Verifier выбирает случайное ребро
+            size_t idx = uniform_int_distribution<size_t>(0, m - 1)(verifierRng[t]);
+            uint32_t u = edges[idx].u, v = edges[idx].v;
+            probe.mark(Phase::Challenge);
+
+            // Шаг 3: Prover открывает коммиты только двух концов ребра
+            ColorOpening ou = prover.open(u), ov = prover.open(v);
+            probe.mark(Phase::Open);
+
+            // Шаг 4: Verifier сверяет открытия с коммитами и сравнивает цвета
+            bool opened = ColorCommitments::hash(ou) == received[u] && ColorCommitments::hash(ov) == received[v];
+            bool differ = ou.color >= 1 && ou.color <= 3 && ov.color >= 1 && ov.color <= 3 && ou.color != ov.color;
+            probe.mark(Phase::Verify);
+            probe.finish(committed, transferred, opened && differ);
+            if (!opened)
+                throw runtime_error("Раунд " + to_string(round + 1) + ": открытие не совпадает с коммитом");
+            if (!differ)
+                throw runtime_error("Раунд " + to_string(round + 1) + ": обнаружено совпадение цветов на ребре (" +
+                                    to_string(u + 1) + ", " + to_string(v + 1) + ") → " + to_string(ou.color) +
+                                    " = " + to_string(ov.color));
+        });
+    } catch (const exception& e) {
+        cout << e.what() << "\n";
+        cout << "Доказательство отклонено.\n";
+        return 1;
+    }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Раундов: " << rounds << " за " << sec << " с (" << size_t(rounds / max(sec, 1e-9))
+         << " раундов/с)\n\n";
+    trace.summary(cout);
+    if (!traceFile.empty()) {
+        try {
+            trace.writeCsv(traceFile);
+        } catch (const exception& e) {
+            cerr << "Ошибка: " << e.what() << "\n";
             return 1;
         }
-
-        // Раскомментируйте для отладки:
-        // cout << "Раунд " << round << ": ребро (" << u+1 << "," << v+1
-        //      << ") → цвета " << cu << " и " << cv << " — OK\n";
+        cout << "Трасса раундов: " << traceFile << "\n";
     }
-
+    cout << "\n";
     cout << "Протокол завершён успешно!\n";
     cout << "С высокой вероятностью Prover действительно знает корректную 3-раскраску.\n";
     return 0;
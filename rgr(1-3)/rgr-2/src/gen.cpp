@@ -3,39 +3,64 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <string>
+#include "graph_bin.hpp"
 
+// Рёбра пишутся в файл сразу по мере генерации: в памяти только цикл (n чисел),
+// поэтому генерируются и графы на миллионы вершин для режима --sparse.
+// С ключом --bin граф и цикл пишутся одним двоичным файлом graph.bin (graph_bin.hpp).
 int main(int argc, char** argv){
-    if(argc<2){
-        std::cout << "Usage: ./gen n\n";
+    std::vector<std::string> args;
+    bool bin = false;
+    for(int i=1;i<argc;i++){
+        if(std::string(argv[i]) == "--bin") bin = true;
+        else args.push_back(argv[i]);
+    }
+    if(args.empty()){
+        std::cout << "Usage: ./gen n [extra_edges] [--bin]\n";
         return 0;
     }
-    int n = std::stoi(argv[1]);
-    if(n<3 || n>1000) return 1;
+    int n = std::stoi(args[0]);
+    if(n<3 || n>100000000) return 1;
+    long long extra = (args.size() >= 2 ? std::stoll(args[1]) : n); // случайных рёбер сверх цикла
+    if(extra < 0) return 1;
 
     std::vector<int> cycle(n);
     for(int i=0;i<n;i++) cycle[i]=i+1;
 
-    std::shuffle(cycle.begin(), cycle.end(), std::mt19937(std::random_device{}()));
-
-    std::vector<std::pair<int,int>> edges;
-
-    // добавляем гамильтонов цикл
-    for(int i=0;i<n;i++){
-        int u=cycle[i], v=cycle[(i+1)%n];
-        edges.push_back({u,v});
-    }
-
-    // добавляем n случайных рёбер
     std::mt19937 rng(std::random_device{}());
-    for(int i=0;i<n;i++){
-        int u=rng()%n+1, v=rng()%n+1;
-        if(u!=v) edges.push_back({u,v});
+    std::shuffle(cycle.begin(), cycle.end(), rng);
+
+    std::uniform_int_distribution<int> vertex(1, n);
+    if(bin){
+        GraphBinWriter w("graph.bin", n, n + extra);
+        for(int i=0;i<n;i++) w.addEdge(cycle[i]-1, cycle[(i+1)%n]-1);
+        for(long long i=0;i<extra;i++){
+            int u = vertex(rng), v;
+            do v = vertex(rng); while(v==u);
+            w.addEdge(u-1, v-1);
+        }
+        std::vector<uint32_t> cyc(n);
+        for(int i=0;i<n;i++) cyc[i] = cycle[i]-1;
+        w.finish(nullptr, cyc.data());
+        std::cout << "Generated graph.bin\n";
+        return 0;
     }
 
-    // записываем graph.txt
     std::ofstream g("graph.txt");
-    g << n << " " << edges.size() << "\n";
-    for(auto& e:edges) g << e.first << " " << e.second << "\n";
+    std::vector<char> buf(1 << 20);
+    g.rdbuf()->pubsetbuf(buf.data(), buf.size());
+    g << n << " " << n + extra << "\n";
+
+    // гамильтонов цикл
+    for(int i=0;i<n;i++) g << cycle[i] << " " << cycle[(i+1)%n] << "\n";
+
+    // extra случайных рёбер без петель
+    for(long long i=0;i<extra;i++){
+        int u = vertex(rng), v;
+        do v = vertex(rng); while(v==u);
+        g << u << " " << v << "\n";
+    }
 
     // записываем cycle.txt
     std::ofstream c("cycle.txt");
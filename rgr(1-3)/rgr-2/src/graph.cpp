@@ -1,26 +1,64 @@
 // graph.cpp
 #include "graph.hpp"
+#include "graph_bin.hpp"
 #include <fstream>
 #include <sstream>
 
+// Двоичный файл отображается в память, рёбра берутся прямо из отображения
+static bool loadBin(Graph& g, const std::string& path){
+    MappedGraph mg(path);
+    if(mg.n()==0 || mg.n() > uint64_t(Graph::MAX_N) || mg.m() > uint64_t(INT32_MAX)) return false;
+    g.n = mg.n();
+    g.m = mg.m();
+    g.adj.assign(g.n);
+    const GraphEdge* e = mg.edges();
+    for(int i=0;i<g.m;i++){
+        if(e[i].u >= uint32_t(g.n) || e[i].v >= uint32_t(g.n)) return false;
+        g.adj.set(e[i].u, e[i].v);
+        g.adj.set(e[i].v, e[i].u);
+    }
+    return true;
+}
+
+// Повреждённый двоичный файл — такая же ошибка загрузки, как и неверный текст
+template<class F>
+static bool tryMapped(F f){
+    try {
+        return f();
+    } catch(const std::exception&) {
+        return false;
+    }
+}
+
 bool Graph::load(const std::string& path){
+    if(isGraphBin(path)) return tryMapped([&]{ return loadBin(*this, path); });
     std::ifstream in(path);
     if(!in) return false;
 
     in >> n >> m;
-    if(n<=0 || n>=1001) return false;
+    if(n<=0 || n>Graph::MAX_N) return false;
 
-    adj.assign(n, std::vector<int>(n,0));
+    adj.assign(n);
     for(int i=0;i<m;i++){
         int u,v; in>>u>>v;
         u--,v--; 
         if(u<0||v<0||u>=n||v>=n) return false;
-        adj[u][v] = adj[v][u] = 1;
+        adj.set(u,v);
+        adj.set(v,u);
     }
     return true;
 }
 
-bool Graph::loadCycle(const std::string& path, std::vector<int>& cyc){
+// Цикл — текстовый файл или секция цикла двоичного графа
+static bool readCycle(const std::string& path, int n, std::vector<int>& cyc){
+    if(isGraphBin(path)) return tryMapped([&]{
+        MappedGraph mg(path);
+        const uint32_t* c = mg.cycle();
+        if(!c || mg.n() != uint64_t(n)) return false;
+        cyc.assign(c, c+n);
+        for(int v : cyc) if(v<0 || v>=n) return false;
+        return true;
+    });
     std::ifstream in(path);
     if(!in) return false;
     cyc.clear();
@@ -32,3 +70,72 @@ bool Graph::loadCycle(const std::string& path, std::vector<int>& cyc){
     }
     return cyc.size() == (size_t)n;
 }
+
+bool Graph::loadCycle(const std::string& path, std::vector<int>& cyc){
+    return readCycle(path, n, cyc);
+}
+
+bool SparseGraph::load(const std::string& path){
+    if(isGraphBin(path)) return tryMapped([&]{
+        MappedGraph mg(path);
+        if(mg.n()==0 || mg.n() > uint64_t(SparseGraph::MAX_N)) return false;
+        n = mg.n();
+        return build(mg.edges(), mg.m());
+    });
+
+    std::ifstream in(path);
+    if(!in) return false;
+    // Число рёбер из заголовка не выделяется заранее: память растёт по мере чтения,
+    // так что неверный заголовок кончается ошибкой загрузки, а не bad_alloc
+    size_t count;
+    if(!(in >> n >> count) || n<=0 || n>SparseGraph::MAX_N) return false;
+    std::vector<GraphEdge> edges;
+    edges.reserve(std::min<size_t>(count, size_t(1) << 20));
+    for(size_t i=0;i<count;i++){
+        int u,v;
+        if(!(in >> u >> v) || u<1 || v<1) return false;
+        edges.push_back({uint32_t(u-1), uint32_t(v-1)});
+    }
+    return build(edges.data(), edges.size());
+}
+
+// Рёбра раскладываются по строкам подсчётом степеней; каждая строка сортируется,
+// повторы и петли выбрасываются
+bool SparseGraph::build(const GraphEdge* edges, size_t count){
+    std::vector<size_t> deg(size_t(n)+1, 0);
+    for(size_t i=0;i<count;i++){
+        uint32_t u = edges[i].u, v = edges[i].v;
+        if(u>=uint32_t(n) || v>=uint32_t(n)) return false;
+        if(u!=v) deg[u]++, deg[v]++;
+    }
+
+    offsets.assign(size_t(n)+1, 0);
+    for(int i=0;i<n;i++) offsets[i+1] = offsets[i] + deg[i];
+    nbr.resize(offsets[n]);
+    std::vector<size_t> pos(offsets.begin(), offsets.end()-1);
+    for(size_t i=0;i<count;i++){
+        uint32_t u = edges[i].u, v = edges[i].v;
+        if(u==v) continue;
+        nbr[pos[u]++] = v;
+        nbr[pos[v]++] = u;
+    }
+
+    size_t out = 0;
+    for(int i=0;i<n;i++){
+        auto b = nbr.begin()+offsets[i], e = nbr.begin()+offsets[i+1];
+        std::sort(b, e);
+        size_t start = out;
+        for(auto it=b; it!=e; ++it)
+            if(it==b || *it != *(it-1)) nbr[out++] = *it;
+        offsets[i] = start;
+    }
+    offsets[n] = out;
+    nbr.resize(out);
+    nbr.shrink_to_fit();
+    m = out/2;
+    return true;
+}
+
+bool SparseGraph::loadCycle(const std::string& path, std::vector<int>& cyc){
+    return readCycle(path, n, cyc);
+}
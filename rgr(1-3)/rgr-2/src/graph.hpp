@@ -1,11 +1,54 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <algorithm>
+
+struct GraphEdge; // graph_bin.hpp
+
+// Квадратная 0/1-матрица n×n, по биту на элемент; каждая строка занимает words слов по 64 бита
+struct BitMatrix {
+    int n{};
+    size_t words{};
+    std::vector<uint64_t> bits;
+
+    void assign(int nn){ // размер nn×nn, все нули; память переиспользуется
+        n = nn;
+        words = (size_t(nn)+63)/64;
+        bits.assign(size_t(nn)*words, 0);
+    }
+    void clear(){ std::fill(bits.begin(), bits.end(), 0); }
+
+    uint64_t* row(int i){ return bits.data() + size_t(i)*words; }
+    const uint64_t* row(int i) const { return bits.data() + size_t(i)*words; }
+
+    bool get(int i, int j) const { return (row(i)[j>>6] >> (j&63)) & 1; }
+    void set(int i, int j){ row(i)[j>>6] |= uint64_t(1) << (j&63); }
+};
 
 struct Graph {
+    static constexpr int MAX_N = 65536; // матрица смежности — до 512 МБ
+
     int n{}, m{};
-    std::vector<std::vector<int>> adj;
+    BitMatrix adj;
+
+    bool load(const std::string& path); // загружает граф: текст или двоичный формат (graph_bin.hpp)
+    bool loadCycle(const std::string& path, std::vector<int>& cyc); // загружает цикл: текст или секция двоичного графа
+};
+
+// Разреженный граф в формате CSR: соседи вершины u — nbr[offsets[u] .. offsets[u+1]),
+// по возрастанию, без повторов и петель. Для графов, которым матрица n×n не по размеру:
+// память — O(n + m).
+struct SparseGraph {
+    static constexpr int MAX_N = 100000000;
+
+    int n{};
+    size_t m{}; // число различных рёбер
+    std::vector<size_t> offsets;
+    std::vector<int> nbr;
 
-    bool load(const std::string& path); // загружает граф
-    bool loadCycle(const std::string& path, std::vector<int>& cyc); // загружает цикл
+    bool load(const std::string& path); // текст или двоичный формат (graph_bin.hpp)
+    bool loadCycle(const std::string& path, std::vector<int>& cyc);
+private:
+    bool build(const GraphEdge* edges, size_t count);
 };
@@ -1,16 +1,57 @@
 #include "graph.hpp"
 #include "zkp.hpp"
+#include "sparse_zkp.hpp"
 #include <iostream>
+#include <string>
+#include <vector>
 
 int main(int argc, char** argv) {
-    if(argc < 3){
-        std::cout << "Usage: ./zkp graph.txt cycle.txt [rounds]\n";
+    // Позиционные аргументы и ключи --batch, --prove file, --sparse, -t threads, --trace file.csv
+    // в любом порядке
+    std::vector<std::string> args;
+    std::string proofFile, traceFile;
+    bool batch = false, sparse = false;
+    unsigned threads = 0;
+    for(int i=1;i<argc;i++){
+        std::string a = argv[i];
+        if(a == "--batch") batch = true;
+        else if(a == "--prove" && i+1 < argc) proofFile = argv[++i];
+        else if(a == "--sparse") sparse = true;
+        else if(a == "-t" && i+1 < argc) threads = std::stoul(argv[++i]);
+        else if(a == "--trace" && i+1 < argc) traceFile = argv[++i];
+        else args.push_back(a);
+    }
+    if(args.size() < 2){
+        std::cout << "Usage: ./zkp graph.txt cycle.txt [rounds] [--batch | --prove proof.bin | --sparse] [-t threads]"
+                     " [--trace trace.csv]\n";
         return 0;
     }
 
-    std::string graphFile = argv[1];
-    std::string cycleFile = argv[2];
-    int rounds = (argc >= 4 ? std::stoi(argv[3]) : 10);
+    std::string graphFile = args[0];
+    std::string cycleFile = args[1];
+    int rounds = (args.size() >= 3 ? std::stoi(args[2]) : 10);
+
+    // Разреженный режим: список смежности вместо матрицы, для n > Graph::MAX_N
+    if(sparse){
+        try {
+            SparseGraph sg;
+            std::vector<int> cycle;
+            if(!sg.load(graphFile)){
+                std::cerr << "Failed to load graph\n";
+                return 1;
+            }
+            if(!sg.loadCycle(cycleFile, cycle)){
+                std::cerr << "Failed to load cycle\n";
+                return 1;
+            }
+            SparseZKP zkp(sg, cycle);
+            zkp.run(rounds);
+        } catch(const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
     Graph g;
     if(!g.load(graphFile)){
@@ -25,7 +66,14 @@ int main(int argc, char** argv) {
     }
 
     ZKP zkp(g, cycle);
-    zkp.run(rounds);
+    try {
+        if(!proofFile.empty()) zkp.prove(rounds, proofFile, threads);
+        else if(batch) zkp.runBatch(rounds, threads);
+        else zkp.run(rounds, traceFile);
+    } catch(const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,172 @@
+#include "merkle.hpp"
+#include "parallel.hpp"
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+// Низкоуровневый SHA256_CTX: одноразовый SHA256() в OpenSSL 3 на каждом вызове ищет
+// реализацию через EVP и на коротких сообщениях в несколько раз медленнее
+void sha256(const uint8_t* data, size_t len, uint8_t* out){
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, data, len);
+    SHA256_Final(out, &ctx);
+}
+
+Digest commitBit(const Nonce& nonce, bool bit){
+    uint8_t buf[1+16+1];
+    buf[0] = 0x00;
+    std::memcpy(buf+1, nonce.data(), 16);
+    buf[17] = bit;
+    Digest d;
+    sha256(buf, sizeof(buf), d.data());
+    return d;
+}
+
+Digest commitEdge(const Nonce& nonce, uint64_t edge){
+    uint8_t buf[1+16+8];
+    buf[0] = 0x04;
+    std::memcpy(buf+1, nonce.data(), 16);
+    for(int i=0;i<8;i++) buf[17+i] = uint8_t(edge >> (8*i));
+    Digest d;
+    sha256(buf, sizeof(buf), d.data());
+    return d;
+}
+
+Nonce deriveNonce(const Digest& seed, uint64_t k){
+    uint8_t buf[1+32+8];
+    buf[0] = 0x02;
+    std::memcpy(buf+1, seed.data(), 32);
+    for(int i=0;i<8;i++) buf[33+i] = uint8_t(k >> (8*i));
+    Digest d;
+    sha256(buf, sizeof(buf), d.data());
+    Nonce n;
+    std::memcpy(n.data(), d.data(), 16);
+    return n;
+}
+
+Digest randomSeed(){
+    Digest s;
+    if(RAND_bytes(s.data(), s.size()) != 1) throw std::runtime_error("RAND_bytes failed");
+    return s;
+}
+
+static Digest hashNode(const Digest& l, const Digest& r){
+    uint8_t buf[1+32+32];
+    buf[0] = 0x01;
+    std::memcpy(buf+1, l.data(), 32);
+    std::memcpy(buf+33, r.data(), 32);
+    Digest d;
+    sha256(buf, sizeof(buf), d.data());
+    return d;
+}
+
+static int treeHeight(size_t leaves){
+    int h = 0;
+    while((size_t(1) << h) < leaves) h++;
+    return h;
+}
+
+void MerkleTree::buildBlock(size_t b, const LeafFn& leaf, std::vector<Digest>& nodes) const {
+    size_t B = size_t(1) << blockHeight;
+    nodes.resize(2*B);
+    for(size_t i=0;i<B;i++){
+        size_t k = b*B + i;
+        nodes[B+i] = k < leafCount ? leaf(k) : Digest{};
+    }
+    for(size_t i=B-1;i>=1;i--) nodes[i] = hashNode(nodes[2*i], nodes[2*i+1]);
+}
+
+void MerkleTree::build(size_t leaves, const LeafFn& leaf, unsigned threads){
+    leafCount = leaves;
+    height = treeHeight(leaves);
+    blockHeight = std::min(height, 6);
+    size_t B = size_t(1) << blockHeight;
+    size_t blocks = (size_t(1) << height) >> blockHeight;
+
+    // Блоки целиком из дополнения одинаковы: их корень — хеш нулевого поддерева
+    size_t usedBlocks = (leaves + B - 1) / B;
+    Digest zero{};
+    for(int h=0;h<blockHeight;h++) zero = hashNode(zero, zero);
+
+    levels.assign(1, std::vector<Digest>(blocks, zero));
+    if(B == 1){ // один лист без дополнения
+        if(leaves) levels[0][0] = leaf(0);
+    } else {
+        std::vector<std::vector<Digest>> nodes(threadCount(threads));
+        parallelFor(usedBlocks, threads, [&](size_t b, unsigned t){
+            buildBlock(b, leaf, nodes[t]);
+            levels[0][b] = nodes[t][1];
+        });
+    }
+
+    while(levels.back().size() > 1){
+        const std::vector<Digest>& low = levels.back();
+        std::vector<Digest> up(low.size()/2);
+        for(size_t i=0;i<up.size();i++) up[i] = hashNode(low[2*i], low[2*i+1]);
+        levels.push_back(std::move(up));
+    }
+}
+
+// Узлы идут по уровням снизу вверх, внутри уровня — по возрастанию индекса: для каждого
+// известного узла, чей сосед не известен, добавляется сосед. Проверяющий восстанавливает
+// тот же порядок из одних номеров листьев.
+std::vector<Digest> MerkleTree::multiProof(const std::vector<size_t>& ks, const LeafFn& leaf) const {
+    std::vector<size_t> known(ks);
+    std::sort(known.begin(), known.end());
+    known.erase(std::unique(known.begin(), known.end()), known.end());
+    if(!known.empty() && known.back() >= leafCount) throw std::out_of_range("MerkleTree::multiProof: no such leaf");
+
+    // Блоки с открываемыми листьями пересчитываются по одному разу
+    size_t B = size_t(1) << blockHeight;
+    std::map<size_t, std::vector<Digest>> blocks;
+    for(size_t k : known)
+        if(B > 1 && !blocks.count(k / B)) buildBlock(k / B, leaf, blocks[k / B]);
+    auto node = [&](int h, size_t idx) -> Digest {
+        if(h >= blockHeight) return levels[h - blockHeight][idx];
+        size_t width = B >> h; // узлов уровня h в блоке
+        return blocks.at(idx / width)[width + idx % width];
+    };
+
+    std::vector<Digest> out;
+    for(int h=0;h<height;h++){
+        for(size_t i=0;i<known.size();i++){
+            if(!(known[i] & 1) && i+1 < known.size() && known[i+1] == known[i]+1) i++;
+            else out.push_back(node(h, known[i]^1));
+        }
+        for(size_t& k : known) k >>= 1;
+        known.erase(std::unique(known.begin(), known.end()), known.end());
+    }
+    return out;
+}
+
+bool MerkleTree::verifyMulti(const Digest& root, size_t leaves, std::vector<std::pair<size_t,Digest>> opened,
+                             const std::vector<Digest>& nodes){
+    std::sort(opened.begin(), opened.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+    for(size_t i=0;i<opened.size();i++)
+        if(opened[i].first >= leaves || (i && opened[i].first == opened[i-1].first)) return false;
+    if(opened.empty()) return false;
+
+    size_t p = 0;
+    int height = treeHeight(leaves);
+    for(int h=0;h<height;h++){
+        std::vector<std::pair<size_t,Digest>> up;
+        up.reserve(opened.size());
+        for(size_t i=0;i<opened.size();i++){
+            size_t idx = opened[i].first;
+            if(!(idx & 1) && i+1 < opened.size() && opened[i+1].first == idx+1){
+                up.emplace_back(idx >> 1, hashNode(opened[i].second, opened[i+1].second));
+                i++;
+            } else {
+                if(p == nodes.size()) return false;
+                const Digest& s = nodes[p++];
+                up.emplace_back(idx >> 1, (idx & 1) ? hashNode(s, opened[i].second) : hashNode(opened[i].second, s));
+            }
+        }
+        opened.swap(up);
+    }
+    return p == nodes.size() && opened[0].second == root;
+}
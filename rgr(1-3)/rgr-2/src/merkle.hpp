@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using Digest = std::array<uint8_t,32>; // SHA-256
+using Nonce = std::array<uint8_t,16>;
+
+void sha256(const uint8_t* data, size_t len, uint8_t* out);
+
+// Коммит одного бита: H(0x00 ‖ nonce ‖ bit)
+Digest commitBit(const Nonce& nonce, bool bit);
+// Коммит ребра, упакованного в 64 бита: H(0x04 ‖ nonce ‖ edge)
+Digest commitEdge(const Nonce& nonce, uint64_t edge);
+// nonce_k = первые 16 байт H(0x02 ‖ seed ‖ k): доказывающему достаточно хранить seed
+Nonce deriveNonce(const Digest& seed, uint64_t k);
+Digest randomSeed(); // OpenSSL RAND_bytes
+
+// Дерево Меркла над leaves листьями, дополненными нулевыми листьями до степени двойки;
+// внутренний узел = H(0x01 ‖ left ‖ right). Нижние уровни внутри блоков по 64 листа
+// не хранятся (памяти — один хеш на блок), при открытии листа блок пересчитывается.
+class MerkleTree {
+public:
+    using LeafFn = std::function<Digest(size_t)>;
+
+    // Корни блоков считаются параллельно в threads потоках (0 — по числу ядер)
+    void build(size_t leaves, const LeafFn& leaf, unsigned threads = 0);
+
+    const Digest& root() const { return levels.back()[0]; }
+    int depth() const { return height; } // длина пути до корня
+
+    // Общее доказательство для набора листьев: узлы, которых не хватает, чтобы из этих листьев
+    // вычислить корень. Общие части путей передаются один раз.
+    std::vector<Digest> multiProof(const std::vector<size_t>& ks, const LeafFn& leaf) const;
+    // opened — пары (номер листа, его хеш)
+    static bool verifyMulti(const Digest& root, size_t leaves, std::vector<std::pair<size_t,Digest>> opened,
+                            const std::vector<Digest>& nodes);
+
+private:
+    size_t leafCount{};
+    int height{}, blockHeight{};
+    std::vector<std::vector<Digest>> levels; // levels[0] — корни блоков, levels.back() — корень
+
+    void buildBlock(size_t b, const LeafFn& leaf, std::vector<Digest>& nodes) const; // nodes[1] — корень блока
+};
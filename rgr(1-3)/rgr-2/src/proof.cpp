@@ -0,0 +1,116 @@
+#include "proof.hpp"
+#include "rng.hpp"
+#include <cstring>
+#include <stdexcept>
+
+static const char PROOF_MAGIC[4] = {'H','C','Z','1'};
+static const char FS_DOMAIN[] = "HCZK-FS";
+
+template<class T>
+static void put(std::vector<uint8_t>& buf, const T& v){
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    buf.insert(buf.end(), p, p+sizeof(T));
+}
+
+Digest graphDigest(const Graph& g){
+    std::vector<uint8_t> buf = {'H','C','G','1'};
+    put(buf, uint32_t(g.n));
+    const uint8_t* rows = reinterpret_cast<const uint8_t*>(g.adj.bits.data());
+    buf.insert(buf.end(), rows, rows + g.adj.bits.size()*sizeof(uint64_t));
+    Digest d;
+    sha256(buf.data(), buf.size(), d.data());
+    return d;
+}
+
+std::vector<int> fiatShamir(const Digest& graph, int n, const std::vector<Digest>& roots){
+    std::vector<uint8_t> buf(FS_DOMAIN, FS_DOMAIN + sizeof(FS_DOMAIN)-1);
+    buf.insert(buf.end(), graph.begin(), graph.end());
+    put(buf, uint32_t(n));
+    put(buf, uint32_t(roots.size()));
+    for(const Digest& r : roots) buf.insert(buf.end(), r.begin(), r.end());
+    Digest key;
+    sha256(buf.data(), buf.size(), key.data());
+
+    CounterRng rng(key, 0);
+    std::vector<int> challenge(roots.size());
+    uint64_t word = 0;
+    for(size_t r=0;r<roots.size();r++){
+        if(r % 64 == 0) word = rng();
+        challenge[r] = (word >> (r % 64)) & 1;
+    }
+    return challenge;
+}
+
+ProofWriter::ProofWriter(const std::string& p, int n, const Digest& graph, const std::vector<Digest>& roots)
+    : path(p), out(p, std::ios::binary | std::ios::trunc) {
+    if(!out) throw std::runtime_error("Cannot create " + path);
+    uint32_t nn = n, rounds = roots.size();
+    out.write(PROOF_MAGIC, 4);
+    out.write(reinterpret_cast<const char*>(&nn), 4);
+    out.write(reinterpret_cast<const char*>(&rounds), 4);
+    out.write(reinterpret_cast<const char*>(graph.data()), graph.size());
+    for(const Digest& r : roots) out.write(reinterpret_cast<const char*>(r.data()), r.size());
+}
+
+void ProofWriter::write(const ZKP::GraphOpening& o){
+    out.write(reinterpret_cast<const char*>(o.perm.data()), o.perm.size()*sizeof(int));
+    out.write(reinterpret_cast<const char*>(o.seed.data()), o.seed.size());
+}
+
+void ProofWriter::write(const ZKP::CycleOpening& o){
+    uint32_t count = o.nodes.size();
+    out.write(reinterpret_cast<const char*>(o.order.data()), o.order.size()*sizeof(int));
+    out.write(reinterpret_cast<const char*>(o.nonces.data()), o.nonces.size()*sizeof(Nonce));
+    out.write(reinterpret_cast<const char*>(&count), 4);
+    out.write(reinterpret_cast<const char*>(o.nodes.data()), o.nodes.size()*sizeof(Digest));
+}
+
+size_t ProofWriter::close(){
+    size_t bytes = out.tellp();
+    out.close();
+    if(!out) throw std::runtime_error("Cannot write " + path);
+    return bytes;
+}
+
+ProofReader::ProofReader(const std::string& path) : in(path, std::ios::binary) {
+    if(!in) throw std::runtime_error("Cannot open " + path);
+    char magic[4];
+    uint32_t nn, rr;
+    in.read(magic, 4);
+    in.read(reinterpret_cast<char*>(&nn), 4);
+    in.read(reinterpret_cast<char*>(&rr), 4);
+    in.read(reinterpret_cast<char*>(graph.data()), graph.size());
+    if(!in || std::memcmp(magic, PROOF_MAGIC, 4) != 0) throw std::runtime_error("Not a proof file: " + path);
+    if(nn < 3 || nn > uint32_t(Graph::MAX_N) || rr == 0 || rr > 1000000)
+        throw std::runtime_error("Bad proof header: " + path);
+    n = nn;
+    rounds = rr;
+    roots.resize(rounds);
+    in.read(reinterpret_cast<char*>(roots.data()), roots.size()*sizeof(Digest));
+    if(!in) throw std::runtime_error("Truncated proof file: " + path);
+}
+
+bool ProofReader::read(ZKP::GraphOpening& o){
+    o.perm.resize(n);
+    in.read(reinterpret_cast<char*>(o.perm.data()), o.perm.size()*sizeof(int));
+    in.read(reinterpret_cast<char*>(o.seed.data()), o.seed.size());
+    return bool(in);
+}
+
+bool ProofReader::read(ZKP::CycleOpening& o){
+    o.order.resize(n);
+    o.nonces.resize(n);
+    uint32_t count;
+    in.read(reinterpret_cast<char*>(o.order.data()), o.order.size()*sizeof(int));
+    in.read(reinterpret_cast<char*>(o.nonces.data()), o.nonces.size()*sizeof(Nonce));
+    in.read(reinterpret_cast<char*>(&count), 4);
+    // Мультидоказательство не длиннее n полных путей (глубина дерева < 64)
+    if(!in || count > uint64_t(n)*64) return false;
+    o.nodes.resize(count);
+    in.read(reinterpret_cast<char*>(o.nodes.data()), o.nodes.size()*sizeof(Digest));
+    return bool(in);
+}
+
+bool ProofReader::atEnd(){
+    return in.peek() == std::ifstream::traits_type::eof();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "graph.hpp"
+#include "zkp.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Неинтерактивное доказательство (преобразование Фиата — Шамира).
+// challenge раунда r — бит r потока 0 счётного генератора с ключом
+// H("HCZK-FS" ‖ H(граф) ‖ n ‖ rounds ‖ корни всех раундов), поэтому ни один корень нельзя
+// подобрать под уже известные challenge. Обманщик угадывает все биты с вероятностью 2^-rounds
+// на попытку и может перебирать попытки оффлайн, поэтому доказательства короче
+// MIN_PROOF_ROUNDS раундов не строятся и не принимаются.
+//
+// Файл (числа little-endian):
+//   "HCZ1", n (u32), rounds (u32), H(граф) (32 байта), корни раундов (rounds × 32)
+//   ответы по раундам:
+//     challenge 0: perm (n × i32), seed (32)
+//     challenge 1: order (n × i32), nonces (n × 16), число узлов (u32), узлы (× 32)
+
+const int MIN_PROOF_ROUNDS = 128;
+
+Digest graphDigest(const Graph& g); // H("HCG1" ‖ n ‖ строки матрицы смежности)
+std::vector<int> fiatShamir(const Digest& graph, int n, const std::vector<Digest>& roots);
+
+class ProofWriter {
+public:
+    ProofWriter(const std::string& path, int n, const Digest& graph, const std::vector<Digest>& roots);
+    void write(const ZKP::GraphOpening& o);
+    void write(const ZKP::CycleOpening& o);
+    size_t close(); // размер файла; исключение, если запись не удалась
+
+private:
+    std::string path;
+    std::ofstream out;
+};
+
+// Читает ответы по одному, не загружая файл целиком
+class ProofReader {
+public:
+    int n{}, rounds{};
+    Digest graph{};
+    std::vector<Digest> roots;
+
+    explicit ProofReader(const std::string& path); // исключение при неверном заголовке
+    bool read(ZKP::GraphOpening& o); // false — файл оборван или ответ некорректен
+    bool read(ZKP::CycleOpening& o);
+    bool atEnd(); // за последним ответом ничего нет
+
+private:
+    std::ifstream in;
+};
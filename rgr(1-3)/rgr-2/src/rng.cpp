@@ -0,0 +1,24 @@
+#include "rng.hpp"
+#include <cstring>
+
+void CounterRng::nextBlock(){
+    uint8_t buf[1+32+8+8];
+    buf[0] = 0x03;
+    std::memcpy(buf+1, key.data(), 32);
+    for(int i=0;i<8;i++){
+        buf[33+i] = uint8_t(stream >> (8*i));
+        buf[41+i] = uint8_t(counter >> (8*i));
+    }
+    counter++;
+    uint8_t out[32];
+    sha256(buf, sizeof(buf), out);
+    std::memcpy(block, out, sizeof(block));
+}
+
+Digest CounterRng::digest(){
+    nextBlock();
+    used = 4;
+    Digest d;
+    std::memcpy(d.data(), block, d.size());
+    return d;
+}
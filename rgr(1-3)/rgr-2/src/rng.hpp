@@ -0,0 +1,29 @@
+#pragma once
+#include "merkle.hpp"
+#include <cstdint>
+
+// Счётный генератор: блок c потока s — SHA-256(0x03 ‖ key ‖ s ‖ c), из блока берутся 4 числа.
+// Потоки с разными s независимы и не зависят от порядка вызовов, поэтому раунд r
+// может готовиться в любом потоке и даёт тот же результат при том же key.
+class CounterRng {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min(){ return 0; }
+    static constexpr result_type max(){ return ~result_type(0); }
+
+    CounterRng(const Digest& k, uint64_t s) : key(k), stream(s) {}
+
+    result_type operator()(){
+        if(used == 4){ nextBlock(); used = 0; }
+        return block[used++];
+    }
+    Digest digest(); // 32 случайных байта — следующий блок целиком
+
+private:
+    Digest key;
+    uint64_t stream, counter{};
+    uint64_t block[4]{};
+    int used{4};
+
+    void nextBlock();
+};
@@ -0,0 +1,125 @@
+#include "sparse_zkp.hpp"
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+SparseZKP::SparseZKP(SparseGraph& gg, const std::vector<int>& cyc) : g(gg), cycle(cyc) {}
+
+size_t SparseZKP::slotCount() const {
+    size_t s = 1;
+    while(s < g.m) s <<= 1;
+    return s;
+}
+
+void SparseZKP::randomPerm(std::vector<int>& p, CounterRng& rng) const {
+    p.resize(g.n);
+    for(int i=0;i<g.n;i++) p[i]=i;
+    std::shuffle(p.begin(), p.end(), rng);
+}
+
+// Рёбра π(G) выписываются в порядке строк CSR, дополняются пустыми слотами и перемешиваются
+// потоком 0 генератора с ключом seed — проверяющий по perm и seed получает тот же порядок
+void SparseZKP::commitGraph(const std::vector<int>& p, std::vector<int>& pinv, const Digest& seed, Commit& C) const {
+    pinv.resize(g.n);
+    for(int i=0;i<g.n;i++) pinv[p[i]] = i;
+
+    C.slots.resize(slotCount());
+    size_t s = 0;
+    for(int u=0;u<g.n;u++)
+        for(size_t e=g.offsets[u]; e<g.offsets[u+1]; e++)
+            if(u < g.nbr[e]) C.slots[s++] = pack(pinv[u], pinv[g.nbr[e]]);
+    std::fill(C.slots.begin()+s, C.slots.end(), Commit::EMPTY);
+
+    CounterRng rng(seed, 0);
+    std::shuffle(C.slots.begin(), C.slots.end(), rng);
+    C.seed = seed;
+    C.tree.build(C.slots.size(), [&C](size_t k){ return C.leaf(k); });
+}
+
+SparseZKP::GraphOpening SparseZKP::openGraph() const {
+    return GraphOpening{perm, commit.seed};
+}
+
+// Слоты рёбер цикла находятся одним проходом по всем слотам
+SparseZKP::CycleOpening SparseZKP::openCycle() const {
+    CycleOpening o;
+    o.order.resize(g.n);
+    o.slots.resize(g.n);
+    o.nonces.resize(g.n);
+    for(int i=0;i<g.n;i++) o.order[i] = inv[cycle[i]];
+
+    std::unordered_map<uint64_t,int> want;
+    want.reserve(g.n);
+    for(int i=0;i<g.n;i++) want[pack(o.order[i], o.order[(i+1)%g.n])] = i;
+    for(size_t s=0;s<commit.slots.size();s++){
+        auto it = want.find(commit.slots[s]);
+        if(it != want.end()) o.slots[it->second] = s;
+    }
+
+    std::vector<size_t> ks(o.slots.begin(), o.slots.end());
+    for(int i=0;i<g.n;i++) o.nonces[i] = deriveNonce(commit.seed, ks[i]);
+    o.nodes = commit.tree.multiProof(ks, [this](size_t k){ return commit.leaf(k); });
+    return o;
+}
+
+bool SparseZKP::checkIsomorphism(const Digest& root, const GraphOpening& o){
+    if(int(o.perm.size()) != g.n) return false;
+    std::vector<char> seen(g.n, 0);
+    for(int v : o.perm){
+        if(v<0 || v>=g.n || seen[v]) return false;
+        seen[v] = 1;
+    }
+    commitGraph(o.perm, checkInv, o.seed, check);
+    return check.tree.root() == root;
+}
+
+// Слоты должны быть различны — это проверяет verifyMulti
+bool SparseZKP::checkCycle(const Digest& root, const CycleOpening& o) const {
+    if(int(o.order.size()) != g.n || o.slots.size() != o.order.size() || o.nonces.size() != o.order.size())
+        return false;
+    std::vector<char> seen(g.n, 0);
+    for(int v : o.order){
+        if(v<0 || v>=g.n || seen[v]) return false;
+        seen[v] = 1;
+    }
+
+    std::vector<std::pair<size_t,Digest>> opened(g.n);
+    for(int i=0;i<g.n;i++)
+        opened[i] = {o.slots[i], commitEdge(o.nonces[i], pack(o.order[i], o.order[(i+1)%g.n]))};
+    return MerkleTree::verifyMulti(root, slotCount(), std::move(opened), o.nodes);
+}
+
+void SparseZKP::run(int rounds){
+    key = randomSeed();
+    std::mt19937 rng(std::random_device{}());
+    size_t total = 0;
+    std::cout << "Sparse graph: n = " << g.n << ", m = " << g.m << ", " << slotCount() << " slots\n";
+    for(int r=1;r<=rounds;r++){
+        std::cout << "\n=== Round " << r << " ===\n";
+        CounterRng prng(key, r);
+        randomPerm(perm, prng);
+        commitGraph(perm, inv, prng.digest(), commit);
+        Digest root = commit.tree.root();
+        int challenge = rng() % 2;
+        std::cout << "Verifier challenge = " << challenge << "\n";
+
+        bool ok;
+        size_t opened;
+        if(challenge==0){
+            GraphOpening o = openGraph();
+            opened = o.bytes();
+            ok = checkIsomorphism(root, o);
+        } else {
+            CycleOpening o = openCycle();
+            opened = o.bytes();
+            ok = checkCycle(root, o);
+        }
+        // корень + challenge + ответ
+        size_t bytes = root.size() + 1 + opened;
+        total += bytes;
+        std::cout << (ok ? "OK\n" : "FAIL\n");
+        std::cout << "Transferred: " << bytes << " bytes\n";
+    }
+    std::cout << "\nTotal transferred: " << total << " bytes in " << rounds << " rounds\n";
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "graph.hpp"
+#include "merkle.hpp"
+#include "rng.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Тот же протокол для разреженного графа: вместо матрицы коммитится список рёбер.
+// Переставленное ребро (a,b), a<b, лежит в слоте s и закрывается как H(0x04 ‖ nonce_s ‖ a ‖ b).
+// Слотов — степень двойки не меньше m, лишние заняты пустыми рёбрами, порядок слотов
+// перемешан: по коммиту видна только степень двойки, а не число рёбер, и по номерам
+// открытых слотов нельзя понять, какие это рёбра.
+struct SparseZKP {
+    SparseGraph& g;
+    std::vector<int> cycle;
+
+    struct Commit {
+        static constexpr uint64_t EMPTY = ~uint64_t(0);
+        std::vector<uint64_t> slots; // (a << 32) | b или EMPTY
+        Digest seed{};
+        MerkleTree tree;
+
+        Digest leaf(size_t s) const { return commitEdge(deriveNonce(seed,s), slots[s]); }
+    };
+
+    // Ответ на challenge 0: перестановка и seed — из seed выводятся и nonce, и порядок слотов
+    struct GraphOpening {
+        std::vector<int> perm;
+        Digest seed{};
+        size_t bytes() const { return perm.size()*4 + seed.size(); }
+    };
+
+    // Ответ на challenge 1: цикл в новой нумерации, слоты и nonce его рёбер, мультидоказательство
+    struct CycleOpening {
+        std::vector<int> order;
+        std::vector<uint32_t> slots;
+        std::vector<Nonce> nonces;
+        std::vector<Digest> nodes;
+        size_t bytes() const {
+            return order.size()*4 + slots.size()*4 + nonces.size()*sizeof(Nonce) + nodes.size()*sizeof(Digest);
+        }
+    };
+
+    SparseZKP(SparseGraph& gg, const std::vector<int>& cyc);
+
+    void run(int rounds);
+private:
+    Digest key{}; // ключ счётного генератора доказывающего, новый в каждом run; раунд r берёт поток r
+
+    // Буферы раунда: выделяются в первом раунде и дальше переиспользуются
+    std::vector<int> perm, inv, checkInv;
+    Commit commit, check;
+
+    static uint64_t pack(int a, int b){
+        if(a>b) std::swap(a,b);
+        return uint64_t(a) << 32 | uint32_t(b);
+    }
+    size_t slotCount() const;
+    void randomPerm(std::vector<int>& p, CounterRng& rng) const;
+    void commitGraph(const std::vector<int>& p, std::vector<int>& pinv, const Digest& seed, Commit& C) const;
+
+    GraphOpening openGraph() const;
+    CycleOpening openCycle() const;
+    bool checkIsomorphism(const Digest& root, const GraphOpening& o);
+    bool checkCycle(const Digest& root, const CycleOpening& o) const;
+};
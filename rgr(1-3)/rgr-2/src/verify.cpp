@@ -0,0 +1,90 @@
+// Проверка файла неинтерактивного доказательства: ответы читаются пачками по несколько
+// раундов на поток и проверяются параллельно, файл целиком в память не загружается
+#include "graph.hpp"
+#include "parallel.hpp"
+#include "proof.hpp"
+#include "zkp.hpp"
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    // --min-rounds K может только поднять порог MIN_PROOF_ROUNDS
+    std::vector<std::string> args;
+    unsigned threads = 0;
+    int minRounds = MIN_PROOF_ROUNDS;
+    for(int i=1;i<argc;i++){
+        std::string a = argv[i];
+        if(a == "-t" && i+1 < argc) threads = std::stoul(argv[++i]);
+        else if(a == "--min-rounds" && i+1 < argc) minRounds = std::max(MIN_PROOF_ROUNDS, std::stoi(argv[++i]));
+        else args.push_back(a);
+    }
+    if(args.size() < 2){
+        std::cout << "Usage: ./verify graph.txt proof.bin [-t threads] [--min-rounds K]\n";
+        return 0;
+    }
+
+    Graph g;
+    if(!g.load(args[0])){
+        std::cerr << "Failed to load graph\n";
+        return 1;
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        ProofReader reader(args[1]);
+        Digest graph = graphDigest(g);
+        if(reader.n != g.n || reader.graph != graph){
+            std::cout << "INVALID: proof is for another graph\n";
+            return 2;
+        }
+        if(reader.rounds < minRounds){
+            std::cout << "INVALID: " << reader.rounds << " rounds, at least " << minRounds << " required\n";
+            return 2;
+        }
+        std::vector<int> challenge = fiatShamir(graph, g.n, reader.roots);
+
+        ZKP zkp(g, {});
+        unsigned T = threadCount(threads);
+        size_t batch = 4*size_t(T);
+        std::vector<ZKP::GraphOpening> go(batch);
+        std::vector<ZKP::CycleOpening> co(batch);
+        std::vector<ZKP::CheckBuffers> checks(T);
+        std::vector<char> ok(batch);
+
+        for(int first=0; first<reader.rounds; first+=batch){
+            size_t count = std::min<size_t>(batch, reader.rounds - first);
+            for(size_t i=0;i<count;i++){
+                bool read = challenge[first+i]==0 ? reader.read(go[i]) : reader.read(co[i]);
+                if(!read){
+                    std::cout << "INVALID: proof is truncated at round " << first+i+1 << "\n";
+                    return 2;
+                }
+            }
+            parallelFor(count, T, [&](size_t i, unsigned t){
+                const Digest& root = reader.roots[first+i];
+                ok[i] = challenge[first+i]==0 ? zkp.checkIsomorphism(root, go[i], checks[t], 1)
+                                               : zkp.checkCycle(root, co[i]);
+            });
+            for(size_t i=0;i<count;i++){
+                if(!ok[i]){
+                    std::cout << "INVALID: round " << first+i+1 << " (challenge " << challenge[first+i] << ")\n";
+                    return 2;
+                }
+            }
+        }
+        if(!reader.atEnd()){
+            std::cout << "INVALID: trailing data after the last round\n";
+            return 2;
+        }
+
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-t0).count();
+        std::cout << "VALID: " << reader.rounds << " rounds, n = " << g.n << ", " << ms << " ms\n";
+        return 0;
+    } catch(const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,68 +1,259 @@
 #include "zkp.hpp"
+#include "parallel.hpp"
+#include "proof.hpp"
+#include "round_trace.hpp"
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <chrono>
 
 ZKP::ZKP(Graph& gg, const std::vector<int>& cyc) : g(gg), cycle(cyc) {}
 
-void ZKP::randomPerm(std::vector<int>& p){
+void ZKP::randomPerm(std::vector<int>& p, CounterRng& rng) const {
     p.resize(g.n);
     for(int i=0;i<g.n;i++) p[i]=i;
-    std::shuffle(p.begin(), p.end(), std::mt19937(std::random_device{}()));
+    std::shuffle(p.begin(), p.end(), rng);
 }
 
-std::vector<std::vector<int>> ZKP::buildPermGraph(const std::vector<int>& p){
-    std::vector<std::vector<int>> a(g.n, std::vector<int>(g.n,0));
-    for(int i=0;i<g.n;i++)
-        for(int j=0;j<g.n;j++)
-            a[i][j] = g.adj[p[i]][p[j]];
-    return a;
+// a[i][j] = adj[p[i]][p[j]]: строка p[i] исходного графа просматривается по словам,
+// каждый установленный бит j' переносится в столбец pinv[j'] — O(n²/64 + m) вместо O(n²)
+void ZKP::buildPermGraph(const std::vector<int>& p, std::vector<int>& pinv, BitMatrix& a) const {
+    pinv.resize(g.n);
+    for(int i=0;i<g.n;i++) pinv[p[i]] = i;
+
+    if(a.n != g.n) a.assign(g.n);
+    else a.clear();
+    for(int i=0;i<g.n;i++){
+        const uint64_t* src = g.adj.row(p[i]);
+        uint64_t* dst = a.row(i);
+        for(size_t w=0;w<g.adj.words;w++){
+            for(uint64_t word=src[w]; word; word &= word-1){
+                int j = pinv[w*64 + __builtin_ctzll(word)];
+                dst[j>>6] |= uint64_t(1) << (j&63);
+            }
+        }
+    }
 }
 
-ZKP::Commit ZKP::commitGraph(const std::vector<std::vector<int>>& a){
-    Commit C;
+// Строки треугольника идут в массиве подряд, поэтому биты собираются последовательным проходом;
+// затем хеши ячеек и дерево Меркла — параллельно по блокам листьев
+void ZKP::commitGraph(const BitMatrix& a, const Digest& seed, Commit& C, unsigned threads) const {
+    C.assign(g.n);
+    C.seed = seed;
+    size_t k = 0;
     for(int i=0;i<g.n;i++)
-        for(int j=i+1;j<g.n;j++)
-            C.bits[{i,j}] = a[i][j];
-    return C;
+        for(int j=i+1;j<g.n;j++,k++)
+            if(a.get(i,j)) C.bits[k>>6] |= uint64_t(1) << (k&63);
+    C.tree.build(C.cells(), [&C](size_t k){ return C.leaf(k); }, threads);
 }
 
-bool ZKP::checkIsomorphism(const Commit& C, const std::vector<std::vector<int>>& a){
-    for(auto& kv : C.bits){
-        auto ij = kv.first;
-        int i=ij.first, j=ij.second;
-        if(a[i][j] != kv.second) return false;
-    }
-    return true;
+// Перестановка и seed раунда r берутся из потока r счётного генератора
+void ZKP::prepareRound(uint64_t r, Round& R, BitMatrix& buf, unsigned threads, RoundProbe* probe) const {
+    CounterRng rng(key, r);
+    randomPerm(R.perm, rng);
+    buildPermGraph(R.perm, R.inv, buf);
+    if(probe) probe->mark(Phase::Permute);
+    commitGraph(buf, rng.digest(), R.commit, threads);
+    if(probe) probe->mark(Phase::Commit);
 }
 
-bool ZKP::checkCycle(const Commit& C, const std::vector<int>& p){
-    std::vector<int> inv(g.n);
-    for(int i=0;i<g.n;i++) inv[p[i]] = i;
+ZKP::GraphOpening ZKP::openGraph(const Round& R) const {
+    return GraphOpening{R.perm, R.commit.seed};
+}
 
+// Номера ячеек рёбер цикла order[i] — order[i+1]
+std::vector<size_t> ZKP::cycleCells(const std::vector<int>& order) const {
+    std::vector<size_t> ks(g.n);
     for(int i=0;i<g.n;i++){
-        int u = inv[cycle[i]];
-        int v = inv[cycle[(i+1)%g.n]];
+        int u = order[i], v = order[(i+1)%g.n];
         if(u>v) std::swap(u,v);
-        if(C.bits.at({u,v}) != 1) return false;
+        ks[i] = Commit::index(g.n,u,v);
     }
-    return true;
+    return ks;
+}
+
+// Для каждого ребра цикла — nonce его ячейки, для всех вместе — одно мультидоказательство
+// Меркла; значение ячейки не передаётся, проверяющий подставляет 1
+ZKP::CycleOpening ZKP::openCycle(const Round& R) const {
+    CycleOpening o;
+    o.order.resize(g.n);
+    o.nonces.resize(g.n);
+    for(int i=0;i<g.n;i++) o.order[i] = R.inv[cycle[i]];
+    std::vector<size_t> ks = cycleCells(o.order);
+    for(int i=0;i<g.n;i++) o.nonces[i] = deriveNonce(R.commit.seed, ks[i]);
+    o.nodes = R.commit.tree.multiProof(ks, [&R](size_t k){ return R.commit.leaf(k); });
+    return o;
 }
 
-void ZKP::run(int rounds){
+// Проверяющий сам строит переставленный граф, выводит nonce из seed и сравнивает корень
+bool ZKP::checkIsomorphism(const Digest& root, const GraphOpening& o, CheckBuffers& buf, unsigned threads) const {
+    if(int(o.perm.size()) != g.n) return false;
+    std::vector<char> seen(g.n, 0);
+    for(int v : o.perm){
+        if(v<0 || v>=g.n || seen[v]) return false;
+        seen[v] = 1;
+    }
+    buildPermGraph(o.perm, buf.inv, buf.graph);
+    commitGraph(buf.graph, o.seed, buf.commit, threads);
+    return buf.commit.tree.root() == root;
+}
+
+bool ZKP::checkCycle(const Digest& root, const CycleOpening& o) const {
+    if(int(o.order.size()) != g.n || o.nonces.size() != o.order.size()) return false;
+    std::vector<char> seen(g.n, 0);
+    for(int v : o.order){
+        if(v<0 || v>=g.n || seen[v]) return false;
+        seen[v] = 1;
+    }
+
+    std::vector<size_t> ks = cycleCells(o.order);
+    std::vector<std::pair<size_t,Digest>> opened(g.n);
+    for(int i=0;i<g.n;i++) opened[i] = {ks[i], commitBit(o.nonces[i], true)};
+    return MerkleTree::verifyMulti(root, size_t(g.n)*(g.n-1)/2, std::move(opened), o.nodes);
+}
+
+// Вывод раунда — после его замера, чтобы печать не попадала во время фаз
+void ZKP::run(int rounds, const std::string& traceFile){
+    key = randomSeed();
     std::mt19937 rng(std::random_device{}());
+    size_t total = 0;
+    RoundTrace trace(std::max(rounds, 0), 1, !traceFile.empty());
     for(int r=1;r<=rounds;r++){
-        std::cout << "\n=== Round " << r << " ===\n";
-        std::vector<int> perm;
-        randomPerm(perm);
-        auto a = buildPermGraph(perm);
-        auto C = commitGraph(a);
+        RoundProbe probe(trace, r);
+        prepareRound(r, round, permGraph, 0, &probe);
+        Digest root = round.commit.tree.root();
         int challenge = rng() % 2;
+        probe.mark(Phase::Challenge);
+
+        bool ok;
+        size_t opened;
+        if(challenge==0){
+            GraphOpening o = openGraph(round);
+            probe.mark(Phase::Open);
+            opened = o.bytes();
+            ok = checkIsomorphism(root, o, checkBuf);
+        } else {
+            CycleOpening o = openCycle(round);
+            probe.mark(Phase::Open);
+            opened = o.bytes();
+            ok = checkCycle(root, o);
+        }
+        probe.mark(Phase::Verify);
+        // корень + challenge + ответ; под коммитом — nonce и бит каждой ячейки
+        size_t bytes = root.size() + 1 + opened;
+        probe.finish(round.commit.cells() * (sizeof(Nonce) + 1), bytes, ok);
+        total += bytes;
+
+        std::cout << "\n=== Round " << r << " ===\n";
         std::cout << "Verifier challenge = " << challenge << "\n";
+        std::cout << (ok ? "OK\n" : "FAIL\n");
+        std::cout << "Transferred: " << bytes << " bytes\n";
+    }
+    std::cout << "\nTotal transferred: " << total << " bytes in " << rounds << " rounds\n\n";
+    trace.summary(std::cout);
+    if(!traceFile.empty()){
+        trace.writeCsv(traceFile);
+        std::cout << "Round trace: " << traceFile << "\n";
+    }
+}
+
+// Раунды независимы, поэтому параллелятся целиком; внутри раунда дерево строится в одном
+// потоке, пока раундов не меньше, чем потоков
+unsigned ZKP::innerThreads(int rounds, unsigned T){
+    return rounds > 0 && unsigned(rounds) < T ? T / rounds : 1;
+}
+
+// Память — состояние всех раундов сразу (около n²/2 байт на раунд: биты ячеек и дерево),
+// а переставленные матрицы — по одной на поток
+std::vector<ZKP::Round> ZKP::prepareRounds(int rounds, unsigned T) const {
+    std::vector<Round> R(rounds);
+    std::vector<BitMatrix> bufs(T);
+    unsigned inner = innerThreads(rounds, T);
+    parallelFor(rounds, T, [&](size_t r, unsigned t){ prepareRound(r+1, R[r], bufs[t], inner); });
+    return R;
+}
+
+void ZKP::runBatch(int rounds, unsigned threads){
+    key = randomSeed();
+    using Clock = std::chrono::steady_clock;
+    unsigned T = threadCount(threads);
+    unsigned inner = innerThreads(rounds, T);
+
+    auto t0 = Clock::now();
+    std::vector<Round> R = prepareRounds(rounds, T);
+    std::vector<Digest> roots(rounds);
+    for(int r=0;r<rounds;r++) roots[r] = R[r].commit.tree.root();
+
+    // Проверяющий получил все корни и только теперь выбирает challenge
+    std::mt19937 rng(std::random_device{}());
+    std::vector<int> challenge(rounds);
+    for(int r=0;r<rounds;r++) challenge[r] = rng() % 2;
+
+    auto t1 = Clock::now();
+    std::vector<char> ok(rounds);
+    std::vector<size_t> bytes(rounds);
+    std::vector<CheckBuffers> checks(T);
+    parallelFor(rounds, T, [&](size_t r, unsigned t){
+        size_t opened;
+        if(challenge[r]==0){
+            GraphOpening o = openGraph(R[r]);
+            opened = o.bytes();
+            ok[r] = checkIsomorphism(roots[r], o, checks[t], inner);
+        } else {
+            CycleOpening o = openCycle(R[r]);
+            opened = o.bytes();
+            ok[r] = checkCycle(roots[r], o);
+        }
+        bytes[r] = roots[r].size() + 1 + opened;
+    });
+    auto t2 = Clock::now();
+
+    size_t total = 0;
+    int passed = 0;
+    for(int r=0;r<rounds;r++){
+        std::cout << "Round " << r+1 << ": challenge = " << challenge[r] << ", " << (ok[r] ? "OK" : "FAIL")
+                  << ", " << bytes[r] << " bytes\n";
+        total += bytes[r];
+        passed += ok[r];
+    }
+    auto ms = [](Clock::duration d){ return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << "\nBatch of " << rounds << " rounds on " << T << " threads: "
+              << (passed==rounds ? "OK" : "FAIL") << " (" << passed << "/" << rounds << ")\n";
+    std::cout << "Commit: " << ms(t1-t0) << " ms, open and verify: " << ms(t2-t1) << " ms\n";
+    std::cout << "Total transferred: " << total << " bytes in " << rounds << " rounds\n";
+}
+
+// Неинтерактивный режим: challenge выводятся из хеша всех корней (proof.hpp), ответы
+// пишутся в файл по раундам
+void ZKP::prove(int rounds, const std::string& path, unsigned threads){
+    if(rounds < MIN_PROOF_ROUNDS)
+        throw std::runtime_error("at least " + std::to_string(MIN_PROOF_ROUNDS) + " rounds are needed for a proof");
+    key = randomSeed();
+    using Clock = std::chrono::steady_clock;
+    unsigned T = threadCount(threads);
+    auto t0 = Clock::now();
+    std::vector<Round> R = prepareRounds(rounds, T);
+
+    std::vector<Digest> roots(rounds);
+    for(int r=0;r<rounds;r++) roots[r] = R[r].commit.tree.root();
+    Digest graph = graphDigest(g);
+    std::vector<int> challenge = fiatShamir(graph, g.n, roots);
+
+    // Ответы считаются параллельно, а пишутся по порядку
+    std::vector<GraphOpening> go(rounds);
+    std::vector<CycleOpening> co(rounds);
+    parallelFor(rounds, T, [&](size_t r, unsigned){
+        if(challenge[r]==0) go[r] = openGraph(R[r]);
+        else co[r] = openCycle(R[r]);
+    });
 
-        if(challenge==0)
-            std::cout << (checkIsomorphism(C,a) ? "OK\n" : "FAIL\n");
-        else
-            std::cout << (checkCycle(C,perm) ? "OK\n" : "FAIL\n");
+    ProofWriter w(path, g.n, graph, roots);
+    for(int r=0;r<rounds;r++){
+        if(challenge[r]==0) w.write(go[r]);
+        else w.write(co[r]);
     }
+    size_t bytes = w.close();
+    auto ms = std::chrono::duration<double, std::milli>(Clock::now()-t0).count();
+    std::cout << "Proof of " << rounds << " rounds written to " << path << ": " << bytes << " bytes, "
+              << ms << " ms\n";
 }
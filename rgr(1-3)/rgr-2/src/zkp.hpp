@@ -1,23 +1,98 @@
 #pragma once
 #include "graph.hpp"
+#include "merkle.hpp"
+#include "rng.hpp"
 #include <vector>
-#include <map>
+#include <string>
+#include <cstdint>
+
+class RoundProbe;
 
 struct ZKP {
     Graph& g;
     std::vector<int> cycle;
 
+    // Коммит верхнего треугольника (i<j) переставленной матрицы: ячейка (i,j) имеет номер
+    // k = i*(2n-i-1)/2 + (j-i-1) и закрывается как H(0 ‖ nonce_k ‖ bit), nonce_k выводится из seed.
+    // Над коммитами ячеек строится дерево Меркла, проверяющему уходит только корень.
     struct Commit {
-        std::map<std::pair<int,int>, int> bits;
+        int n{};
+        std::vector<uint64_t> bits; // значения ячеек в том же порядке, по биту на ячейку
+        Digest seed{};
+        MerkleTree tree;
+
+        static size_t index(int n, int i, int j){ return size_t(i)*(2*size_t(n)-i-1)/2 + (j-i-1); }
+        size_t cells() const { return size_t(n)*(n-1)/2; }
+        void assign(int nn){
+            n = nn;
+            bits.assign((size_t(nn)*(nn-1)/2+63)/64, 0);
+        }
+        bool bit(size_t k) const { return (bits[k>>6] >> (k&63)) & 1; }
+        bool get(int i, int j) const { return bit(index(n,i,j)); }
+        Digest leaf(size_t k) const { return commitBit(deriveNonce(seed,k), bit(k)); }
+    };
+
+    // Ответ на challenge 0: перестановка и seed — из них проверяющий восстанавливает
+    // переставленный граф и все nonce, то есть открываются все ячейки
+    struct GraphOpening {
+        std::vector<int> perm;
+        Digest seed{};
+        size_t bytes() const { return perm.size()*4 + seed.size(); }
+    };
+
+    // Ответ на challenge 1: цикл в новой нумерации, nonce ячеек его рёбер и общее
+    // мультидоказательство Меркла для этих ячеек
+    struct CycleOpening {
+        std::vector<int> order;
+        std::vector<Nonce> nonces;
+        std::vector<Digest> nodes;
+        size_t bytes() const { return order.size()*4 + nonces.size()*sizeof(Nonce) + nodes.size()*sizeof(Digest); }
+    };
+
+    // Состояние доказывающего в одном раунде: до challenge хранится всё, что нужно для ответа
+    struct Round {
+        std::vector<int> perm, inv;
+        Commit commit;
     };
 
     ZKP(Graph& gg, const std::vector<int>& cyc);
 
-    void run(int rounds);
+    // Раунды по очереди; сводка замеров фаз в конце, при непустом traceFile — трасса раундов в CSV
+    void run(int rounds, const std::string& traceFile = "");
+    // Пакетный режим: коммиты всех раундов готовятся параллельно в threads потоках
+    // (0 — по числу ядер), затем проверяющий разом выбирает challenge и параллельно проверяет ответы
+    void runBatch(int rounds, unsigned threads = 0);
+    // Неинтерактивное доказательство (Фиат — Шамир) в файл path, формат — в proof.hpp
+    void prove(int rounds, const std::string& path, unsigned threads = 0);
+
+    // Проверки ответов — общие для интерактивного режима и программы verify
+    struct CheckBuffers { // буферы для challenge 0
+        std::vector<int> inv;
+        BitMatrix graph;
+        Commit commit;
+    };
+    bool checkIsomorphism(const Digest& root, const GraphOpening& o, CheckBuffers& buf, unsigned threads = 0) const;
+    bool checkCycle(const Digest& root, const CycleOpening& o) const;
+
 private:
-    void randomPerm(std::vector<int>& p); // случайная перестановка
-    std::vector<std::vector<int>> buildPermGraph(const std::vector<int>& p); // переставленный граф
-    Commit commitGraph(const std::vector<std::vector<int>>& a); 
-    bool checkIsomorphism(const Commit& C, const std::vector<std::vector<int>>& a);
-    bool checkCycle(const Commit& C, const std::vector<int>& p);
+    // Ключ счётного генератора доказывающего, раунд r берёт поток r. Новый ключ в каждом
+    // run/runBatch/prove: иначе повторный сеанс открыл бы тот же раунд с другим challenge
+    Digest key{};
+
+    // Буферы последовательного режима: выделяются в первом раунде и дальше переиспользуются
+    Round round;
+    BitMatrix permGraph;
+    CheckBuffers checkBuf;
+
+    void randomPerm(std::vector<int>& p, CounterRng& rng) const; // случайная перестановка
+    void buildPermGraph(const std::vector<int>& p, std::vector<int>& pinv, BitMatrix& a) const; // переставленный граф в a
+    void commitGraph(const BitMatrix& a, const Digest& seed, Commit& C, unsigned threads = 0) const; // C.tree.root() — коммит раунда
+    // probe, если задан, отмечает фазы перестановки и коммита
+    void prepareRound(uint64_t r, Round& R, BitMatrix& buf, unsigned threads = 0, RoundProbe* probe = nullptr) const;
+    std::vector<Round> prepareRounds(int rounds, unsigned T) const; // раунды 1..rounds параллельно
+    static unsigned innerThreads(int rounds, unsigned T); // потоков на дерево одного раунда
+
+    GraphOpening openGraph(const Round& R) const;
+    CycleOpening openCycle(const Round& R) const;
+    std::vector<size_t> cycleCells(const std::vector<int>& order) const;
 };
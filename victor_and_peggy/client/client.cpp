@@ -5,6 +5,57 @@
 #include <unistd.h>
 #include <cstring>
 #include <string>
+#include "../common/protocol.hpp"
+
+// Кадры сервера: read дописывает в buf, кадр возвращается, как только он собран целиком.
+// Лишние байты (следующие кадры из того же read) остаются в буфере до следующего вызова.
+class FrameReader {
+public:
+    explicit FrameReader(int sock) : sock(sock) {}
+
+    // false — соединение закрыто или кадр некорректен
+    bool next(Frame& f) {
+        buf.erase(0, used);
+        used = 0;
+        while (true) {
+            ParseStatus st = parse_frame(buf, f, used);
+            if (st == ParseStatus::OK) return true;
+            if (st != ParseStatus::INCOMPLETE) return false;
+            char chunk[1024];
+            ssize_t bytes = read(sock, chunk, sizeof(chunk));
+            if (bytes <= 0) return false;
+            buf.append(chunk, bytes);
+        }
+    }
+
+private:
+    int sock;
+    std::string buf;
+    size_t used = 0;           // длина кадра, выданного последним
+};
+
+static void send_frame(int sock, MsgType type, const std::string& payload) {
+    std::string frame;
+    append_frame(frame, type, payload);
+    send(sock, frame.data(), frame.size(), 0);
+}
+
+// Следующий кадр должен иметь тип type; ERROR от сервера печатается
+static bool expect(FrameReader& reader, MsgType type, Frame& f, const char* what) {
+    if (!reader.next(f)) {
+        std::cerr << "Failed to receive " << what << "\n";
+        return false;
+    }
+    if (f.type == MsgType::ERROR) {
+        std::cerr << "Server error: " << std::string(f.payload) << "\n";
+        return false;
+    }
+    if (f.type != type) {
+        std::cerr << "Unexpected message instead of " << what << "\n";
+        return false;
+    }
+    return true;
+}
 
 int main(int argc, char** argv) {
     if (argc != 2) {
@@ -13,6 +64,10 @@ int main(int argc, char** argv) {
     }
 
     std::string login = argv[1];
+    if (login.size() > MAX_PAYLOAD) {
+        std::cerr << "Login is too long\n";
+        return 1;
+    }
     srand(time(0));
 
     int sock = socket(AF_INET, SOCK_STREAM, 0);
@@ -28,69 +83,57 @@ int main(int argc, char** argv) {
     }
 
     // Отправляем логин
-    send(sock, login.c_str(), login.size(), 0);
-
-    char buffer[1024] = {0};
-    ssize_t bytes = read(sock, buffer, sizeof(buffer));
-    if (bytes <= 0) { std::cerr << "Failed to receive n\n"; close(sock); return 1; }
-    int n = atoi(buffer);
+    send_frame(sock, MsgType::HELLO, login);
+
+    // Получаем n и k одним кадром
+    FrameReader reader(sock);
+    Frame f;
+    uint64_t n, k;
+    if (!expect(reader, MsgType::PARAMS, f, "n and k")) { close(sock); return 1; }
+    if (!get_le(f.payload, 0, 8, n) || !get_le(f.payload, 8, 4, k) || n < 2) {
+        std::cerr << "Malformed parameters\n";
+        close(sock);
+        return 1;
+    }
     std::cout << "Received n: " << n << "\n";
-
-    memset(buffer, 0, sizeof(buffer));
-    bytes = read(sock, buffer, sizeof(buffer));
-    if (bytes <= 0) { std::cerr << "Failed to receive k\n"; close(sock); return 1; }
-    int k = atoi(buffer);
     std::cout << "Number of rounds: " << k << "\n";
 
-    // Секрет клиента 
-    int s = 7;
-    //int s = 2;
+    // Секрет клиента
+    long long s = 7;
+    //long long s = 2;
 
-    for (int i = 0; i < k; ++i) {
-        int r = 1 + rand() % (n - 1);
-        int x = (r * r) % n;
+    for (uint64_t i = 0; i < k; ++i) {
+        long long r = 1 + rand() % (n - 1);
+        long long x = (r * r) % n;
 
         // Отправляем x серверу
-        std::string x_msg = std::to_string(x);
-        send(sock, x_msg.c_str(), x_msg.size(), 0);
+        send_frame(sock, MsgType::COMMIT, encode_uint(x, 8));
 
         // Получаем challenge e
-        memset(buffer, 0, sizeof(buffer));
-        bytes = read(sock, buffer, sizeof(buffer));
-        if (bytes <= 0) { std::cerr << "No challenge received\n"; break; }
-        int e = atoi(buffer);
+        uint64_t e;
+        if (!expect(reader, MsgType::CHALLENGE, f, "challenge") || !decode_uint(f.payload, 1, e)) break;
         std::cout << "e = " << e << "\n";
 
-        int y = (e == 0) ? r : (r * s) % n;
+        long long y = (e == 0) ? r : (r * s) % n;
 
         // Отправляем y серверу
-        std::string y_msg = std::to_string(y);
-        send(sock, y_msg.c_str(), y_msg.size(), 0);
+        send_frame(sock, MsgType::RESPONSE, encode_uint(y, 8));
 
         // Получаем результат раунда
-        memset(buffer, 0, sizeof(buffer));
-        bytes = read(sock, buffer, sizeof(buffer));
-        if (bytes <= 0) { std::cerr << "No result from server\n"; break; }
-        std::string round_result(buffer, bytes);
-        std::cout << "Round " << i + 1 << " result: " << round_result << "\n";
-
-        if (round_result == "FAIL") {
-            std::cout << "Authentication failed!\n";
-            close(sock);
-            return 0;
-        }
+        uint64_t ok;
+        if (!expect(reader, MsgType::RESULT, f, "round result") || !decode_uint(f.payload, 1, ok)) break;
+        std::cout << "Round " << i + 1 << " result: " << (ok ? "OK" : "FAIL") << "\n";
+
+        if (!ok) break;
     }
 
     // Финальный результат
-    memset(buffer, 0, sizeof(buffer));
-    bytes = read(sock, buffer, sizeof(buffer));
-    if (bytes > 0) {
-        std::string final_result(buffer, bytes);
-        if (final_result == "SUCCESS")
-            std::cout << "Authentication successful!\n";
-        else
-            std::cout << "Authentication failed!\n";
-    }
+    uint64_t success = 0;
+    if (expect(reader, MsgType::FINAL, f, "final result")) decode_uint(f.payload, 1, success);
+    if (success)
+        std::cout << "Authentication successful!\n";
+    else
+        std::cout << "Authentication failed!\n";
 
     close(sock);
     return 0;
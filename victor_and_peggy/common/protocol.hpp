@@ -0,0 +1,93 @@
+#pragma once
+// Двоичный протокол клиента и сервера. Каждое сообщение — кадр:
+//
+//   0  uint8   версия протокола (PROTOCOL_VERSION)
+//   1  uint8   тип сообщения (MsgType)
+//   2  uint16  длина полезной нагрузки, little-endian
+//   4  ...     нагрузка
+//
+// Числа в нагрузке — little-endian фиксированной ширины. Длина в заголовке позволяет
+// собирать кадр из нескольких read и разбирать несколько кадров из одного, поэтому
+// разбиение и склейка TCP-сегментов на протокол не влияют.
+//
+// Обмен:
+//   C → S  HELLO     логин (байты, до MAX_PAYLOAD)
+//   S → C  PARAMS    n: uint64, k: uint32          или ERROR с текстом
+//   k раз:
+//   C → S  COMMIT    x: uint64
+//   S → C  CHALLENGE e: uint8
+//   C → S  RESPONSE  y: uint64
+//   S → C  RESULT    ok: uint8
+//   S → C  FINAL     success: uint8                после последнего раунда или первой ошибки
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+const uint8_t PROTOCOL_VERSION = 1;
+const size_t FRAME_HEADER = 4;
+const size_t MAX_PAYLOAD = 1024;
+
+enum class MsgType : uint8_t {
+    HELLO = 1,
+    PARAMS,
+    COMMIT,
+    CHALLENGE,
+    RESPONSE,
+    RESULT,
+    FINAL,
+    ERROR,
+};
+
+struct Frame {
+    MsgType type;
+    std::string_view payload;  // указывает в буфер, из которого кадр разобран
+};
+
+// Кадр дописывается в конец out
+inline void append_frame(std::string& out, MsgType type, std::string_view payload) {
+    char header[FRAME_HEADER] = {char(PROTOCOL_VERSION), char(type), char(payload.size() & 0xff),
+                                 char(payload.size() >> 8)};
+    out.append(header, FRAME_HEADER);
+    out.append(payload);
+}
+
+// Результат разбора начала буфера
+enum class ParseStatus { OK, INCOMPLETE, BAD_VERSION, TOO_LONG };
+
+// При OK в frame — первый кадр буфера, в used — его полная длина
+inline ParseStatus parse_frame(std::string_view buf, Frame& frame, size_t& used) {
+    if (buf.size() < FRAME_HEADER) return ParseStatus::INCOMPLETE;
+    if (uint8_t(buf[0]) != PROTOCOL_VERSION) return ParseStatus::BAD_VERSION;
+    size_t len = uint8_t(buf[2]) | size_t(uint8_t(buf[3])) << 8;
+    if (len > MAX_PAYLOAD) return ParseStatus::TOO_LONG;
+    if (buf.size() < FRAME_HEADER + len) return ParseStatus::INCOMPLETE;
+    frame.type = MsgType(uint8_t(buf[1]));
+    frame.payload = buf.substr(FRAME_HEADER, len);
+    used = FRAME_HEADER + len;
+    return ParseStatus::OK;
+}
+
+// Целые фиксированной ширины: put_le дописывает bytes младших байт x
+inline void put_le(std::string& out, uint64_t x, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) out.push_back(char(x >> (8 * i)));
+}
+
+// false, если нагрузка короче off + bytes
+inline bool get_le(std::string_view in, size_t off, size_t bytes, uint64_t& x) {
+    if (in.size() < off + bytes) return false;
+    x = 0;
+    for (size_t i = 0; i < bytes; ++i) x |= uint64_t(uint8_t(in[off + i])) << (8 * i);
+    return true;
+}
+
+// Нагрузка из одного числа ширины bytes
+inline std::string encode_uint(uint64_t x, size_t bytes) {
+    std::string s;
+    put_le(s, x, bytes);
+    return s;
+}
+
+inline bool decode_uint(std::string_view in, size_t bytes, uint64_t& x) {
+    return in.size() == bytes && get_le(in, 0, bytes, x);
+}
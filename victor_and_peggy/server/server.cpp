@@ -1,110 +1,364 @@
+// Сборка: g++ -O2 -pthread server.cpp -o server
+// Запуск: ./server [-t потоков] — по умолчанию по числу ядер
+
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <cerrno>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <netinet/in.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <unistd.h>
+#include <csignal>
 #include <cstring>
+#include "user_store.hpp"
+#include "../common/protocol.hpp"
+
+const int PORT = 12345;
+const int ROUNDS = 3;          // количество проверок
+const int IDLE_TIMEOUT = 30;   // секунд без данных от клиента до разрыва
+const size_t MAX_EVENTS = 256;
 
-struct User {
-    std::string login;
-    int n;
-    int v;
+// Состояние одного соединения: сервер ждёт от клиента либо HELLO с логином, либо COMMIT
+// с x, либо RESPONSE с y (протокол — ../common/protocol.hpp). После итогового сообщения
+// соединение закрывается, как только отправлен весь буфер.
+struct Connection {
+    enum State { WAIT_LOGIN, WAIT_X, WAIT_Y, CLOSING };
+
+    int fd;
+    State state = WAIT_LOGIN;
+    User user;
+    int round = 0;
+    long long x = 0;
+    int e = 0;
+    std::string in;            // принятые байты, ещё не сложившиеся в кадр
+    std::string out;           // кадры к отправке
+    bool want_write = false;   // в epoll включён EPOLLOUT
+    time_t last_active;
 };
 
-User find_user(const std::string& login) {
-    std::ifstream file("users.txt");
-    std::string l;
-    int n, v;
-    while (file >> l >> n >> v) {
-        if (l == login) return {l, n, v};
+// Цикл событий одного потока: свой слушающий сокет (SO_REUSEPORT), свой epoll и свои
+// соединения, поэтому реакторы ничего не делят и не берут общих блокировок. Таблица
+// пользователей общая и только для чтения.
+class Reactor {
+public:
+    Reactor(int listen_fd, const UserStore& store)
+        : listen_fd(listen_fd), store(store), rng(std::random_device{}()) {
+        epoll_fd = epoll_create1(0);
+        if (epoll_fd < 0) { perror("epoll_create1"); exit(1); }
+        watch(listen_fd, EPOLLIN, EPOLL_CTL_ADD);
     }
-    return {"", 0, 0};
-}
 
-int main() {
-    srand(time(0));
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        time_t last_sweep = time(0);
+        while (true) {
+            refresh_users();
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, 1000);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait");
+                exit(1);
+            }
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listen_fd) { accept_all(); continue; }
 
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd == 0) { perror("socket"); exit(1); }
+                auto it = conns.find(fd);
+                if (it == conns.end()) continue;
+                Connection& c = it->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) { drop(c); continue; }
+                if ((events[i].events & EPOLLOUT) && !flush(c)) continue;
+                if (events[i].events & EPOLLIN) on_readable(c);
+            }
 
-    sockaddr_in address{};
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(12345);
+            time_t now = time(0);
+            if (now != last_sweep) { sweep(now); last_sweep = now; }
+            flush_log();
+        }
+    }
 
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) { perror("bind"); exit(1); }
-    if (listen(server_fd, 5) < 0) { perror("listen"); exit(1); }
-
-    std::cout << "Server listening on port 12345...\n";
-
-    while (true) {
-        sockaddr_in client_addr{};
-        socklen_t addrlen = sizeof(client_addr);
-        int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &addrlen);
-        if (client_fd < 0) { perror("accept"); continue; }
-
-        char buffer[1024] = {0};
-        ssize_t bytes = read(client_fd, buffer, sizeof(buffer));
-        if (bytes <= 0) { close(client_fd); continue; }
-
-        std::string login(buffer, bytes);
-        User u = find_user(login);
-        if (u.login.empty()) {
-            std::string msg = "ERROR: User not found";
-            send(client_fd, msg.c_str(), msg.size(), 0);
-            std::cout << "User not found: " << login << "\n";
-            close(client_fd);
-            continue;
+private:
+    int listen_fd, epoll_fd;
+    const UserStore& store;
+    std::shared_ptr<const UserTable> users;
+    uint64_t users_version = UINT64_MAX;
+    std::unordered_map<int, Connection> conns;
+    std::mt19937 rng;
+    std::string log;           // строки журнала за итерацию цикла
+
+    // Новая таблица после перечитывания файла забирается между итерациями цикла
+    void refresh_users() {
+        uint64_t v = store.version();
+        if (v == users_version) return;
+        users = store.snapshot();
+        users_version = v;
+    }
+
+    // Журнал выводится одним write в конце итерации, а не через общий std::cout
+    void flush_log() {
+        size_t done = 0;
+        while (done < log.size()) {
+            ssize_t w = write(STDOUT_FILENO, log.data() + done, log.size() - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            done += w;
         }
+        log.clear();
+    }
 
-        // отправляем n
-        std::string n_msg = std::to_string(u.n);
-        send(client_fd, n_msg.c_str(), n_msg.size(), 0);
+    void watch(int fd, uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, op, fd, &ev) < 0) perror("epoll_ctl");
+    }
 
-        int k = 3; // количество проверок
-        std::string k_msg = std::to_string(k);
-        send(client_fd, k_msg.c_str(), k_msg.size(), 0);
-        bool auth_fail = false;
+    void accept_all() {
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) perror("accept");
+                return;
+            }
+            Connection c;
+            c.fd = fd;
+            c.last_active = time(0);
+            conns.emplace(fd, c);
+            watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+        }
+    }
 
-        for (int i = 0; i < k; ++i) {
-            // получаем x
-            memset(buffer, 0, sizeof(buffer));
-            bytes = read(client_fd, buffer, sizeof(buffer));
-            if (bytes <= 0) { auth_fail = true; break; }
-            int x = atoi(buffer);
+    void drop(Connection& c) {
+        close(c.fd);               // закрытый дескриптор сам уходит из epoll
+        conns.erase(c.fd);
+    }
 
-            // challenge
-            int e = rand() % 2;
-            std::string c_msg = std::to_string(e);
-            send(client_fd, c_msg.c_str(), c_msg.size(), 0);
+    // Разрыв соединений, которые молчат дольше IDLE_TIMEOUT
+    void sweep(time_t now) {
+        for (auto it = conns.begin(); it != conns.end();) {
+            if (now - it->second.last_active > IDLE_TIMEOUT) {
+                close(it->first);
+                it = conns.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
 
-            // получаем y
-            memset(buffer, 0, sizeof(buffer));
-            bytes = read(client_fd, buffer, sizeof(buffer));
-            if (bytes <= 0) { auth_fail = true; break; }
-            int y = atoi(buffer);
+    // Кадры копятся в out и уходят одним send после разбора всего прочитанного;
+    // при EAGAIN остаток дописывается по EPOLLOUT
+    void send_msg(Connection& c, MsgType type, std::string_view payload = {}) {
+        append_frame(c.out, type, payload);
+    }
 
-            int lhs = (y * y) % u.n;
-            int rhs = (x * (e ? u.v : 1)) % u.n;
+    // false — соединение закрыто
+    bool flush(Connection& c) {
+        size_t done = 0;
+        while (done < c.out.size()) {
+            ssize_t sent = send(c.fd, c.out.data() + done, c.out.size() - done, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    c.out.erase(0, done);
+                    if (!c.want_write) watch(c.fd, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);
+                    c.want_write = true;
+                    return true;
+                }
+                drop(c);
+                return false;
+            }
+            done += sent;
+        }
+        c.out.clear();
+        if (c.state == Connection::CLOSING) { drop(c); return false; }
+        if (c.want_write) watch(c.fd, EPOLLIN, EPOLL_CTL_MOD);
+        c.want_write = false;
+        return true;
+    }
 
-            std::string result = (lhs == rhs) ? "OK" : "FAIL";
-            send(client_fd, result.c_str(), result.size(), 0);
+    // Прочитанное дописывается к входному буферу, из него разбираются все целые кадры;
+    // хвост неполного кадра ждёт следующего read
+    void on_readable(Connection& c) {
+        char buffer[4096];
+        ssize_t bytes = read(c.fd, buffer, sizeof(buffer));
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+        if (bytes <= 0) {
+            if (c.state != Connection::WAIT_LOGIN && c.state != Connection::CLOSING)
+                log += c.user.login + " authentication: FAIL\n";
+            drop(c);
+            return;
+        }
+        c.last_active = time(0);
+        c.in.append(buffer, bytes);
 
-            if (lhs != rhs) {
-                //std::cout << "Authentication failed for " << u.login << "\n";
-                auth_fail = true;
+        size_t pos = 0;
+        while (c.state != Connection::CLOSING) {
+            Frame f;
+            size_t used;
+            ParseStatus st = parse_frame(std::string_view(c.in).substr(pos), f, used);
+            if (st == ParseStatus::INCOMPLETE) break;
+            if (st != ParseStatus::OK) {
+                reject(c, st == ParseStatus::BAD_VERSION ? "unsupported protocol version" : "frame too long");
                 break;
             }
+            on_message(c, f);
+            pos += used;
         }
+        c.in.erase(0, pos);
+        flush(c);
+    }
 
-        std::string final_msg = auth_fail ? "FAIL" : "SUCCESS";
-        send(client_fd, final_msg.c_str(), final_msg.size(), 0);
-        std::cout << login << " authentication: " << final_msg << "\n";
+    // Нарушение протокола: ERROR с причиной и закрытие; начатая аутентификация не пройдена
+    void reject(Connection& c, const std::string& reason) {
+        if (c.state == Connection::WAIT_X || c.state == Connection::WAIT_Y)
+            log += c.user.login + " authentication: FAIL (" + reason + ")\n";
+        send_msg(c, MsgType::ERROR, reason);
+        c.state = Connection::CLOSING;
+    }
+
+    void on_message(Connection& c, const Frame& f) {
+        switch (c.state) {
+        case Connection::WAIT_LOGIN: {
+            if (f.type != MsgType::HELLO) return reject(c, "expected HELLO");
+            c.user = users->find(f.payload);
+            if (c.user.login.empty()) {
+                send_msg(c, MsgType::ERROR, "User not found");
+                log += "User not found: " + std::string(f.payload) + "\n";
+                c.state = Connection::CLOSING;
+                return;
+            }
+            // отправляем n и k
+            std::string params;
+            put_le(params, c.user.n, 8);
+            put_le(params, ROUNDS, 4);
+            send_msg(c, MsgType::PARAMS, params);
+            c.state = Connection::WAIT_X;
+            return;
+        }
+        case Connection::WAIT_X: {
+            uint64_t x;
+            if (f.type != MsgType::COMMIT || !decode_uint(f.payload, 8, x)) return reject(c, "expected COMMIT");
+            c.x = x % c.user.n;
+            // challenge
+            c.e = rng() % 2;
+            send_msg(c, MsgType::CHALLENGE, encode_uint(c.e, 1));
+            c.state = Connection::WAIT_Y;
+            return;
+        }
+        case Connection::WAIT_Y: {
+            uint64_t yy;
+            if (f.type != MsgType::RESPONSE || !decode_uint(f.payload, 8, yy)) return reject(c, "expected RESPONSE");
+            const User& u = c.user;
+            long long y = yy % u.n;
+            long long lhs = (y * y) % u.n;
+            long long rhs = (c.x * (c.e ? u.v : 1)) % u.n;
+            bool ok = lhs == rhs;
+            send_msg(c, MsgType::RESULT, encode_uint(ok, 1));
+            if (ok && ++c.round < ROUNDS) {
+                c.state = Connection::WAIT_X;
+                return;
+            }
+            send_msg(c, MsgType::FINAL, encode_uint(ok, 1));
+            log += u.login + " authentication: " + (ok ? "SUCCESS" : "FAIL") + "\n";
+            c.state = Connection::CLOSING;
+            return;
+        }
+        case Connection::CLOSING:
+            return;
+        }
+    }
+};
+
+// Тысячи одновременных соединений упираются в лимит дескрипторов: мягкий лимит
+// поднимается до жёсткого
+static void raise_fd_limit() {
+    rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+}
+
+// С SO_REUSEPORT bind второго сервера того же пользователя на тот же порт проходит без
+// ошибки, и ядро делит соединения между двумя процессами. Поэтому сервер сначала берёт
+// flock на файл, привязанный к порту; блокировка держится до выхода процесса.
+static void lock_port() {
+    std::string path = "/tmp/victor_and_peggy." + std::to_string(PORT) + ".lock";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) { perror(path.c_str()); exit(1); }
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+        char pid[32] = {};
+        ssize_t n = read(fd, pid, sizeof(pid) - 1);
+        std::cerr << "Another server is already running on port " << PORT;
+        if (n > 0) std::cerr << " (pid " << std::string(pid, strcspn(pid, "\n")) << ")";
+        std::cerr << ", lock " << path << "\n";
+        exit(1);
+    }
+    std::string pid = std::to_string(getpid()) + "\n";
+    if (ftruncate(fd, 0) < 0 || write(fd, pid.data(), pid.size()) < 0) perror(path.c_str());
+}
+
+// Слушающий сокет реактора. С SO_REUSEPORT каждый поток открывает свой сокет на тот же порт,
+// и ядро само распределяет входящие соединения между ними по хешу адресов
+static int make_listener() {
+    int server_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server_fd < 0) { perror("socket"); exit(1); }
+    int one = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) { perror("SO_REUSEPORT"); exit(1); }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(PORT);
 
-        close(client_fd);
+    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) { perror("bind"); exit(1); }
+    if (listen(server_fd, SOMAXCONN) < 0) { perror("listen"); exit(1); }
+    return server_fd;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    if (argc == 3 && std::string(argv[1]) == "-t") threads = atoi(argv[2]);
+    else if (argc != 1) {
+        std::cerr << "Usage: ./server [-t threads]\n";
+        return 1;
     }
+    if (threads == 0) threads = 1;
+
+    signal(SIGPIPE, SIG_IGN);
+    raise_fd_limit();
+    lock_port();
+
+    // Пользователи загружаются один раз, дальше файл перечитывается только при изменении
+    std::unique_ptr<UserStore> store;
+    try {
+        store = std::make_unique<UserStore>("users.txt");
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    store->watch();
+    std::cout << "Users loaded: " << store->snapshot()->size() << "\n";
+
+    // Сокеты открываются до запуска потоков: ошибка bind (порт занят чужим процессом) видна
+    // сразу; второй экземпляр этого же сервера останавливает lock_port
+    std::vector<int> listeners;
+    for (unsigned i = 0; i < threads; ++i) listeners.push_back(make_listener());
+
+    std::cout << "Server listening on port " << PORT << " (" << threads << " threads)...\n" << std::flush;
 
-    close(server_fd);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i)
+        workers.emplace_back([fd = listeners[i], &store] { Reactor(fd, *store).run(); });
+    Reactor(listeners[0], *store).run();
 }
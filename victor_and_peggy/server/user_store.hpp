@@ -0,0 +1,159 @@
+#pragma once
+// Открытые ключи пользователей в памяти. Файл users.txt (строки "login n v") читается
+// целиком в один буфер, индекс — хеш-таблица login → (n, v) со string_view на этот буфер,
+// поиск O(1) без копирования логинов. Таблица после загрузки не меняется: при изменении
+// файла (inotify) в отдельном потоке строится новая и подменяет старую, а логины всё это
+// время обслуживаются по старой.
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+struct User {
+    std::string login;
+    int n;
+    int v;
+};
+
+class UserTable {
+public:
+    // std::runtime_error, если файл не читается или строка не разбирается
+    explicit UserTable(const std::string& path) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) throw std::runtime_error("cannot open " + path);
+        char chunk[1 << 16];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) text.append(chunk, got);
+        bool failed = ferror(f);
+        fclose(f);
+        if (failed) throw std::runtime_error("cannot read " + path);
+        parse(path);
+    }
+    UserTable(const UserTable&) = delete;
+    UserTable& operator=(const UserTable&) = delete;
+
+    // Пустой login в ответе — пользователь не найден
+    User find(std::string_view login) const {
+        auto it = index.find(login);
+        if (it == index.end()) return {"", 0, 0};
+        return {std::string(login), it->second.n, it->second.v};
+    }
+
+    size_t size() const { return index.size(); }
+
+private:
+    struct Key {
+        int n, v;
+    };
+
+    std::string text;                                  // содержимое файла, на него ссылается index
+    std::unordered_map<std::string_view, Key> index;
+
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    // Поля разделены любыми пробелами, как при чтении через >>; при повторе логина
+    // действует первая запись, как при линейном поиске
+    void parse(const std::string& path) {
+        index.reserve(text.size() / 16);
+        const char* p = text.data();
+        const char* end = p + text.size();
+        auto token = [&]() -> std::string_view {
+            while (p < end && is_space(*p)) ++p;
+            const char* start = p;
+            while (p < end && !is_space(*p)) ++p;
+            return std::string_view(start, p - start);
+        };
+        auto number = [&](std::string_view t, int& out) {
+            char buf[16];
+            if (t.empty() || t.size() >= sizeof(buf)) return false;
+            t.copy(buf, t.size());
+            buf[t.size()] = 0;
+            char* stop;
+            errno = 0;
+            long x = strtol(buf, &stop, 10);
+            if (*stop || errno || x < INT32_MIN || x > INT32_MAX) return false;
+            out = int(x);
+            return true;
+        };
+        while (true) {
+            std::string_view login = token();
+            if (login.empty()) break;
+            Key k;
+            if (!number(token(), k.n) || !number(token(), k.v) || k.n <= 0)
+                throw std::runtime_error(path + ": bad record for '" + std::string(login) + "'");
+            index.emplace(login, k);
+        }
+    }
+};
+
+// Текущая таблица и её номер версии. Реактор держит свою копию shared_ptr и на каждой
+// итерации цикла сверяет только номер версии (атомарное чтение без блокировок); при
+// расхождении забирает новую таблицу. Старая освобождается, когда её отпустит последний реактор.
+class UserStore {
+public:
+    explicit UserStore(std::string path) : path(std::move(path)) {
+        current = std::make_shared<const UserTable>(this->path);
+    }
+
+    uint64_t version() const { return ver.load(std::memory_order_acquire); }
+    std::shared_ptr<const UserTable> snapshot() const { return std::atomic_load(&current); }
+
+    // Поток, перечитывающий файл при его изменении. Следится каталог: редакторы и скрипты
+    // часто пишут новый файл рядом и переименовывают его поверх старого.
+    void watch() {
+        size_t slash = path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+        name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+        int fd = inotify_init1(IN_CLOEXEC);
+        if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            perror("inotify");
+            if (fd >= 0) close(fd);
+            return;
+        }
+        std::thread([this, fd] { watch_loop(fd); }).detach();
+    }
+
+private:
+    std::string path, name;
+    std::shared_ptr<const UserTable> current;
+    std::atomic<uint64_t> ver{0};
+
+    void watch_loop(int fd) {
+        alignas(inotify_event) char buf[4096];
+        while (true) {
+            ssize_t len = read(fd, buf, sizeof(buf));
+            if (len < 0 && errno == EINTR) continue;
+            if (len <= 0) { perror("inotify read"); return; }
+
+            bool changed = false;
+            for (ssize_t off = 0; off < len;) {
+                const inotify_event* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                if (ev->len && name == ev->name) changed = true;
+                off += sizeof(inotify_event) + ev->len;
+            }
+            if (changed) reload();
+        }
+    }
+
+    // Файл, который не разбирается (например, записан наполовину), не заменяет рабочую таблицу
+    void reload() {
+        try {
+            auto table = std::make_shared<const UserTable>(path);
+            std::atomic_store(&current, table);
+            ver.fetch_add(1, std::memory_order_release);
+            fprintf(stderr, "users reloaded: %zu\n", table->size());
+        } catch (const std::exception& e) {
+            fprintf(stderr, "users reload failed, keeping previous table: %s\n", e.what());
+        }
+    }
+};